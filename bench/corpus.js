@@ -0,0 +1,119 @@
+var fs = require('fs'),
+    os = require('os'),
+    path = require('path'),
+    mkdir = require('mkdirp');
+
+/**
+ * Number of component partials imported by each corpus
+ */
+
+var sizes = {
+  small: 1,
+  medium: 40,
+  large: 400
+};
+
+/**
+ * Variables partial
+ *
+ * @api private
+ */
+
+function variables() {
+  var out = [];
+
+  for (var i = 0; i < 50; i++) {
+    out.push('$color-' + i + ': rgb(' + (i * 5) + ', ' + (255 - i * 5) + ', ' + (i * 3) + ');');
+    out.push('$space-' + i + ': ' + (i * 4) + 'px;');
+  }
+
+  return out.join('\n') + '\n';
+}
+
+/**
+ * Mixins partial
+ *
+ * @api private
+ */
+
+function mixins() {
+  return [
+    '@mixin box($pad, $color) {',
+    '  padding: $pad;',
+    '  border: 1px solid darken($color, 10%);',
+    '  background: lighten($color, 20%);',
+    '}',
+    '',
+    '@mixin grid($columns) {',
+    '  @for $i from 1 through $columns {',
+    '    .col-#{$i} { width: percentage($i / $columns); }',
+    '  }',
+    '}',
+    '',
+    '%clearfix {',
+    '  zoom: 1;',
+    '  &:after { content: ""; display: table; clear: both; }',
+    '}',
+    ''
+  ].join('\n');
+}
+
+/**
+ * Component partial
+ *
+ * @param {Number} i
+ * @api private
+ */
+
+function component(i) {
+  var n = i % 50;
+
+  return [
+    '.component-' + i + ' {',
+    '  @extend %clearfix;',
+    '  @include box($space-' + n + ', $color-' + n + ');',
+    '  margin: $space-' + n + ' * 2 auto;',
+    '',
+    '  .header {',
+    '    color: $color-' + ((n + 1) % 50) + ';',
+    '    font-size: 12px + ' + (i % 8) + ';',
+    '',
+    '    a { text-decoration: none; &:hover { color: $color-' + n + '; } }',
+    '  }',
+    '',
+    '  .body { @include grid(' + (2 + i % 6) + '); }',
+    '}',
+    ''
+  ].join('\n');
+}
+
+/**
+ * Write corpus
+ *
+ * Generates a stylesheet project of the given size under the system temp
+ * directory and returns the path of its entry file.
+ *
+ * @param {String} size
+ * @api public
+ */
+
+module.exports = function(size) {
+  var dir = path.join(os.tmpdir(), 'node-sass-bench', size);
+  var imports = ['@import "variables";', '@import "mixins";'];
+
+  mkdir.sync(dir);
+  fs.writeFileSync(path.join(dir, '_variables.scss'), variables());
+  fs.writeFileSync(path.join(dir, '_mixins.scss'), mixins());
+
+  for (var i = 0; i < sizes[size]; i++) {
+    fs.writeFileSync(path.join(dir, '_component-' + i + '.scss'), component(i));
+    imports.push('@import "component-' + i + '";');
+  }
+
+  var entry = path.join(dir, 'index.scss');
+  fs.writeFileSync(entry, imports.join('\n') + '\n');
+
+  return entry;
+};
+
+module.exports.sizes = Object.keys(sizes);
@@ -0,0 +1,333 @@
+var os = require('os'),
+    path = require('path'),
+    sass = require('../lib'),
+    corpus = require('./corpus');
+
+/**
+ * Compiles per run, by corpus size
+ */
+
+var iterations = {
+  small: 500,
+  medium: 100,
+  large: 20
+};
+
+/**
+ * Peak RSS sampler
+ *
+ * @api private
+ */
+
+function Sampler() {
+  var self = this;
+
+  this.peak = process.memoryUsage().rss;
+  this.timer = setInterval(function() {
+    self.sample();
+  }, 5);
+}
+
+Sampler.prototype.sample = function() {
+  this.peak = Math.max(this.peak, process.memoryUsage().rss);
+};
+
+Sampler.prototype.stop = function() {
+  clearInterval(this.timer);
+  this.sample();
+  return this.peak;
+};
+
+/**
+ * Milliseconds since `start`
+ *
+ * @param {Array} start
+ * @api private
+ */
+
+function since(start) {
+  var diff = process.hrtime(start);
+  return diff[0] * 1e3 + diff[1] / 1e6;
+}
+
+/**
+ * Percentile of sorted latencies
+ *
+ * @param {Array} sorted
+ * @param {Number} p
+ * @api private
+ */
+
+function percentile(sorted, p) {
+  return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+/**
+ * Sync runner
+ *
+ * @param {Function} compile
+ * @param {Number} n
+ * @param {Function} cb
+ * @api private
+ */
+
+function runSync(compile, n, cb) {
+  var latencies = [];
+  var stats = [];
+
+  for (var i = 0; i < n; i++) {
+    var start = process.hrtime();
+    stats.push(compile());
+    latencies.push(since(start));
+  }
+
+  cb(latencies, stats);
+}
+
+/**
+ * Async runner
+ *
+ * Submits all `n` compiles at once and measures each from submission to
+ * its callback, so queueing in the compile pool is part of the latency.
+ *
+ * @param {Function} compile
+ * @param {Number} n
+ * @param {Function} cb
+ * @api private
+ */
+
+function runAsync(compile, n, cb) {
+  var latencies = [];
+  var stats = [];
+  var pending = n;
+
+  for (var i = 0; i < n; i++) {
+    (function(start) {
+      compile(function(s) {
+        latencies.push(since(start));
+        stats.push(s);
+
+        if (--pending === 0) {
+          cb(latencies, stats);
+        }
+      });
+    })(process.hrtime());
+  }
+}
+
+/**
+ * Batch runner
+ *
+ * @param {Function} options
+ * @param {Number} n
+ * @param {Function} cb
+ * @api private
+ */
+
+function runBatch(options, n, cb) {
+  var latencies = [];
+  var batch = [];
+  var start = process.hrtime();
+
+  for (var i = 0; i < n; i++) {
+    batch.push(options({
+      stats: {},
+      success: function() {
+        latencies.push(since(start));
+      }
+    }));
+  }
+
+  sass.renderBatch(batch, function(err, results) {
+    cb(latencies, results.map(function(result) {
+      return result.stats;
+    }));
+  });
+}
+
+/**
+ * Benchmarked APIs
+ *
+ * Each takes the compile options and returns a runner.
+ */
+
+var apis = {
+  renderSync: function(options) {
+    return runSync.bind(null, function() {
+      var opts = options({ stats: {} });
+
+      sass.renderSync(opts);
+      return opts.stats;
+    });
+  },
+
+  render: function(options) {
+    return runAsync.bind(null, function(done) {
+      var opts = options({
+        stats: {},
+        success: function() {
+          done(opts.stats);
+        }
+      });
+
+      sass.render(opts);
+    });
+  },
+
+  renderFile: function(options) {
+    var outFile = path.join(os.tmpdir(), 'node-sass-bench', 'out.css');
+
+    return runAsync.bind(null, function(done) {
+      var stats = {};
+      var opts = options({
+        stats: stats,
+        success: function() {
+          done(stats);
+        }
+      });
+
+      opts.outFile = outFile;
+      sass.renderFile(opts);
+    });
+  },
+
+  renderBatch: function(options) {
+    return runBatch.bind(null, options);
+  }
+};
+
+/**
+ * Measure
+ *
+ * @param {Function} run
+ * @param {Number} n
+ * @param {Function} cb
+ * @api private
+ */
+
+function measure(run, n, cb) {
+  var sampler = new Sampler();
+  var start = process.hrtime();
+
+  run(n, function(latencies, stats) {
+    var total = since(start);
+
+    function median(pick) {
+      return percentile(stats.map(pick).sort(byValue), 0.5);
+    }
+
+    latencies.sort(byValue);
+
+    cb({
+      rate: n / (total / 1e3),
+      p50: percentile(latencies, 0.5),
+      p99: percentile(latencies, 0.99),
+      queued: median(function(s) {
+        return s.queuedMs;
+      }),
+      marshal: median(function(s) {
+        return s.marshalMs + s.callbackMs;
+      }),
+      compile: median(function(s) {
+        return s.compileMs;
+      }),
+      rss: sampler.stop() / 1048576
+    });
+  });
+}
+
+/**
+ * Numeric sort
+ *
+ * @api private
+ */
+
+function byValue(a, b) {
+  return a - b;
+}
+
+/**
+ * Format result row
+ *
+ * @param {Array} columns
+ * @api private
+ */
+
+function row(columns) {
+  return columns.map(function(column, i) {
+    column = typeof column === 'number' ? column.toFixed(2) : String(column);
+    return i < 2 ? (column + '            ').slice(0, 12) : ('            ' + column).slice(-12);
+  }).join('');
+}
+
+/**
+ * Run every API over every corpus in sequence
+ *
+ * The `queued`, `marshal` and `libsass` columns are medians of the native
+ * per-phase timings in `stats`; `marshal` covers both option marshalling
+ * and result conversion.
+ *
+ * @param {Array} filter
+ * @api private
+ */
+
+function run(filter) {
+  var jobs = [];
+
+  corpus.sizes.forEach(function(size) {
+    var entry = corpus(size);
+
+    Object.keys(apis).filter(function(api) {
+      return !filter.length || filter.indexOf(api) !== -1;
+    }).forEach(function(api) {
+      jobs.push({ api: api, size: size, entry: entry });
+    });
+  });
+
+  console.log('concurrency: ' + sass.getConcurrency());
+  console.log(row(['api', 'corpus', 'files/sec', 'p50 ms', 'p99 ms', 'queued ms', 'marshal ms', 'libsass ms', 'peak RSS MB']));
+
+  (function next() {
+    var job = jobs.shift();
+
+    if (!job) {
+      return;
+    }
+
+    var compile = apis[job.api](function(opts) {
+      opts.file = job.entry;
+      return opts;
+    });
+
+    measure(compile, iterations[job.size], function(result) {
+      console.log(row([
+        job.api,
+        job.size,
+        result.rate,
+        result.p50,
+        result.p99,
+        result.queued,
+        result.marshal,
+        result.compile,
+        result.rss
+      ]));
+
+      next();
+    });
+  })();
+}
+
+/**
+ * Run
+ *
+ * Usage: npm run bench [-- [--concurrency n] [api...]]
+ */
+
+var args = process.argv.slice(2);
+var concurrency = args.indexOf('--concurrency');
+
+if (concurrency !== -1) {
+  sass.setConcurrency(args.splice(concurrency, 2)[1]);
+}
+
+run(args);
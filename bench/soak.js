@@ -0,0 +1,292 @@
+var fs = require('fs'),
+    os = require('os'),
+    path = require('path'),
+    sass = require('../lib'),
+    corpus = require('./corpus');
+
+/**
+ * Sources for the success and error paths
+ */
+
+var source = '$color: #333;\n.a { .b { color: $color; width: 10px * 2; } }';
+var broken = '.a {\n  color: $undefined;\n}';
+
+/**
+ * Async compiles kept in flight at once
+ */
+
+var WINDOW = 64;
+
+/**
+ * Growth allowed between the first and the last sample, in bytes
+ */
+
+var SLACK = 32 * 1048576;
+
+/**
+ * Output of the `renderFile` compiles, removed on exit
+ */
+
+var outFile = path.join(os.tmpdir(), 'node-sass-soak-' + process.pid + '.css');
+
+process.on('exit', function() {
+  [outFile, outFile + '.map'].forEach(function(file) {
+    try {
+      fs.unlinkSync(file);
+    } catch (err) {}
+  });
+});
+
+/**
+ * Cancelled compiles, to alternate between queued and running ones
+ */
+
+var cancels = 0;
+
+/**
+ * Soaked compiles
+ *
+ * Each is called with a callback and covers one path through the binding,
+ * so a leak shows up in the one whose samples grow.
+ */
+
+var compiles = {
+  render: function(done) {
+    sass.render({ data: source, success: function() { done(); }, error: done });
+  },
+
+  renderError: function(done) {
+    sass.render({ data: source + broken, success: done, error: function() { done(); } });
+  },
+
+  renderBuffer: function(done) {
+    sass.render({ data: source, outputBuffer: true, success: function() { done(); }, error: done });
+  },
+
+  renderFile: function(done) {
+    sass.renderFile({ file: corpus('small'), sourceMap: true, outFile: outFile, stats: {}, success: function() { done(); }, error: done });
+  },
+
+  // every other compile is cancelled while still queued, the rest once a
+  // thread may have started it, which also drops its write
+  renderCancel: function(done) {
+    var handle = sass.renderFile({
+      file: corpus('small'),
+      outFile: outFile,
+      success: function() { done(); },
+      error: function(err, status) { done(status === 'ECANCELED' ? null : err); }
+    });
+
+    if (cancels++ % 2) {
+      return handle.cancel();
+    }
+
+    setImmediate(function() {
+      handle.cancel();
+    });
+  },
+
+  renderSync: function(done) {
+    sass.renderSync({ data: source });
+    done();
+  },
+
+  renderSyncError: function(done) {
+    try {
+      sass.renderSync({ data: source + broken });
+    } catch (err) {
+      return done();
+    }
+
+    done(new Error('renderSync did not throw'));
+  },
+
+  renderStyles: function(done) {
+    sass.render({ data: source, outputStyle: ['nested', 'compressed'], success: function() { done(); }, error: done });
+  }
+};
+
+/**
+ * Sample
+ *
+ * RSS after a full collection, when `--expose-gc` allows one, and the
+ * number of open handles and requests.
+ *
+ * @api private
+ */
+
+function sample() {
+  if (global.gc) {
+    global.gc();
+  }
+
+  return {
+    rss: process.memoryUsage().rss,
+    handles: process._getActiveHandles().length,
+    requests: process._getActiveRequests().length
+  };
+}
+
+/**
+ * Run `n` compiles, `WINDOW` at a time
+ *
+ * Sync compiles finish while the window is being filled, so after a full
+ * window the rest is deferred to let samples and the loop get a turn.
+ *
+ * @param {Function} compile
+ * @param {Number} n
+ * @param {Function} cb
+ * @api private
+ */
+
+function run(compile, n, cb) {
+  var started = 0;
+  var finished = 0;
+  var filling = false;
+  var failed = null;
+
+  function next() {
+    var burst = 0;
+
+    filling = true;
+    while (started < n && started - finished < WINDOW && burst < WINDOW && !failed) {
+      started++;
+      burst++;
+      compile(done);
+    }
+    filling = false;
+
+    if (burst === WINDOW && started - finished < WINDOW) {
+      setImmediate(next);
+    }
+  }
+
+  function done(err) {
+    finished++;
+    failed = failed || (err ? new Error(String(err)) : null);
+
+    if (finished === started && (started === n || failed)) {
+      return cb(failed);
+    }
+
+    if (!filling) {
+      next();
+    }
+  }
+
+  next();
+}
+
+/**
+ * Soak
+ *
+ * Runs `rounds` rounds of `n` compiles and fails if RSS grew by more than
+ * `SLACK` or any handle or request was left open after the first round,
+ * which also warms up the allocator, the wrapper pool and the caches.
+ *
+ * @param {String} name
+ * @param {Number} rounds
+ * @param {Number} n
+ * @param {Function} cb
+ * @api private
+ */
+
+function soak(name, rounds, n, cb) {
+  var samples = [];
+
+  (function round() {
+    run(compiles[name], n, function(err) {
+      if (err) {
+        return cb(err);
+      }
+
+      samples.push(sample());
+
+      if (samples.length < rounds) {
+        return setImmediate(round);
+      }
+
+      var first = samples[0];
+      var last = samples[samples.length - 1];
+      var problems = [];
+
+      if (last.rss - first.rss > SLACK) {
+        problems.push('RSS grew from ' + mb(first.rss) + ' to ' + mb(last.rss));
+      }
+
+      if (last.handles > first.handles || last.requests > first.requests) {
+        problems.push('handles grew from ' + first.handles + '/' + first.requests + ' to ' + last.handles + '/' + last.requests);
+      }
+
+      console.log(name + ': ' + samples.map(function(s) {
+        return mb(s.rss);
+      }).join(' ') + (problems.length ? '  FAIL: ' + problems.join(', ') : '  ok'));
+
+      cb(null, !problems.length);
+    });
+  })();
+}
+
+/**
+ * Format bytes as MB
+ *
+ * @param {Number} bytes
+ * @api private
+ */
+
+function mb(bytes) {
+  return (bytes / 1048576).toFixed(1) + 'MB';
+}
+
+/**
+ * Run
+ *
+ * Usage: npm run soak [-- [--compiles n] [--rounds n] [compile...]]
+ *
+ * Exits with 1 if any compile leaked.
+ */
+
+var args = process.argv.slice(2);
+var total = 1000000;
+var rounds = 10;
+
+['--compiles', '--rounds'].forEach(function(flag) {
+  var i = args.indexOf(flag);
+
+  if (i !== -1) {
+    var value = parseInt(args.splice(i, 2)[1], 10);
+
+    if (flag === '--compiles') {
+      total = value;
+    } else {
+      rounds = value;
+    }
+  }
+});
+
+if (!global.gc) {
+  console.warn('run with --expose-gc for stable RSS samples');
+}
+
+var names = Object.keys(compiles).filter(function(name) {
+  return !args.length || args.indexOf(name) !== -1;
+});
+var leaked = false;
+
+(function next() {
+  var name = names.shift();
+
+  if (!name) {
+    process.exit(leaked ? 1 : 0);
+  }
+
+  soak(name, rounds, Math.ceil(total / rounds), function(err, ok) {
+    if (err) {
+      console.error(name + ': ' + err.message);
+      process.exit(1);
+    }
+
+    leaked = leaked || !ok;
+    next();
+  });
+})();
@@ -1,10 +1,25 @@
 {
+  'variables': {
+    # opt-in optimized builds, set by `node scripts/build.js --lto --pgo
+    # --native`; see "Optimized builds" in the README
+    'sass_lto%': 'false',
+    'sass_native%': 'false',
+    # `generate` or `use`, with profiles kept in `sass_pgo_dir`
+    'sass_pgo%': '',
+    'sass_pgo_dir%': ''
+  },
   'targets': [
     {
       'target_name': 'binding',
       'sources': [
         'src/binding.cpp',
+        'src/compile_pool.cpp',
+        'src/compiled_options.cpp',
+        'src/memory_budget.cpp',
+        'src/prelude.cpp',
         'src/sass_context_wrapper.cpp',
+        'src/source_buffer.cpp',
+        'src/watcher.cpp',
         'src/libsass/ast.cpp',
         'src/libsass/base64vlq.cpp',
         'src/libsass/bind.cpp',
@@ -86,6 +101,68 @@
           'cflags_cc+': [
             '-std=c++0x'
           ]
+        }],
+        ['OS!="win" and OS!="mac"', {
+          # the binding's own `operator new` has to be the one libsass
+          # calls, rather than the first found in the process
+          'ldflags': [
+            '-Wl,-Bsymbolic-functions'
+          ]
+        }],
+        ['sass_lto=="true" and OS=="win"', {
+          'msvs_settings': {
+            'VCCLCompilerTool': {
+              'WholeProgramOptimization': 'true'
+            },
+            'VCLinkerTool': {
+              'LinkTimeCodeGeneration': 1
+            }
+          }
+        }],
+        ['sass_lto=="true" and OS=="mac"', {
+          'xcode_settings': {
+            'LLVM_LTO': 'YES'
+          }
+        }],
+        ['sass_lto=="true" and OS!="win" and OS!="mac"', {
+          'cflags': [
+            '-flto'
+          ],
+          'ldflags': [
+            '-flto'
+          ]
+        }],
+        ['sass_native=="true" and OS=="mac"', {
+          # OTHER_CPLUSPLUSFLAGS is set above without $(inherited), so it
+          # doesn't pick up OTHER_CFLAGS
+          'xcode_settings': {
+            'OTHER_CFLAGS': [
+              '-march=native'
+            ],
+            'OTHER_CPLUSPLUSFLAGS': [
+              '-march=native'
+            ]
+          }
+        }],
+        ['sass_native=="true" and OS!="win" and OS!="mac"', {
+          'cflags': [
+            '-march=native'
+          ]
+        }],
+        ['sass_pgo=="generate" and OS!="win" and OS!="mac"', {
+          'cflags': [
+            '-fprofile-generate=<(sass_pgo_dir)'
+          ],
+          'ldflags': [
+            '-fprofile-generate=<(sass_pgo_dir)'
+          ]
+        }],
+        ['sass_pgo=="use" and OS!="win" and OS!="mac"', {
+          'cflags': [
+            '-fprofile-use=<(sass_pgo_dir)',
+            '-fprofile-correction',
+            '-Wno-missing-profile'
+          ]
         }]
       ]
     }
@@ -0,0 +1,696 @@
+var crypto = require('crypto'),
+    fs = require('fs'),
+    path = require('path'),
+    mkdir = require('mkdirp');
+
+/**
+ * Options that change the generated CSS or source map
+ */
+
+var keyOptions = [
+  'file',
+  'outFile',
+  'style',
+  'precision',
+  'comments',
+  'indentedSyntax',
+  'omitSourceMapUrl',
+  'sourceMap',
+  'paths',
+  'imagePath'
+];
+
+/**
+ * Get file signature
+ *
+ * @param {String} file
+ * @param {fs.Stats} stat
+ * @api private
+ */
+
+function getSignature(file, stat) {
+  return stat ? { path: file, mtime: stat.mtime.getTime(), size: stat.size } : null;
+}
+
+/**
+ * Get file signature synchronously
+ *
+ * @param {String} file
+ * @api private
+ */
+
+function statSignature(file) {
+  try {
+    return getSignature(file, fs.statSync(file));
+  } catch (err) {
+    return null;
+  }
+}
+
+/**
+ * Stat signatures
+ *
+ * Calls `cb` with the signature of each file, `null` for those that can't
+ * be stat'ed, without blocking the loop.
+ *
+ * @param {Array} files
+ * @param {Function} cb
+ * @api private
+ */
+
+function statSignatures(files, cb) {
+  var signatures = [];
+  var pending = files.length;
+
+  if (!pending) {
+    return process.nextTick(function() {
+      cb(signatures);
+    });
+  }
+
+  files.forEach(function(file, i) {
+    fs.stat(file, function(err, stat) {
+      signatures[i] = getSignature(file, err ? null : stat);
+
+      if (--pending === 0) {
+        cb(signatures);
+      }
+    });
+  });
+}
+
+/**
+ * Is the file of `signature` unchanged
+ *
+ * An entry's files are only signed by the first lookup after the compile.
+ * Until then a file counts as unchanged as long as it was last modified
+ * before the compile started; files modified after that may have been read
+ * half-way through it.
+ *
+ * @param {Object} entry
+ * @param {Number} i
+ * @param {Object} current
+ * @api private
+ */
+
+function isCurrent(entry, i, current) {
+  var signature = entry.files[i];
+
+  if (current === null) {
+    return false;
+  }
+
+  if (!signature) {
+    entry.files[i] = current;
+    return current.mtime < entry.start;
+  }
+
+  return current.mtime === signature.mtime && current.size === signature.size;
+}
+
+/**
+ * Convert
+ *
+ * Cached output is handed out as a `Buffer` with `outputBuffer` and as a
+ * string otherwise, whichever kind of compile stored it.
+ *
+ * @param {String|Buffer} value
+ * @param {Boolean} asBuffer
+ * @api private
+ */
+
+function convert(value, asBuffer) {
+  if (value === null || value === undefined || Buffer.isBuffer(value) === Boolean(asBuffer)) {
+    return value;
+  }
+
+  return asBuffer ? new Buffer(value) : value.toString();
+}
+
+/**
+ * Output of an entry for `options`
+ *
+ * @param {Object} entry
+ * @param {Object} options
+ * @api private
+ */
+
+function output(entry, options) {
+  return entry && {
+    css: convert(entry.css, options.outputBuffer),
+    sourceMap: convert(entry.sourceMap, options.outputBuffer),
+    includedFiles: entry.includedFiles
+  };
+}
+
+/**
+ * Entries kept by default
+ */
+
+var MAX_ENTRIES = 500;
+
+/**
+ * Cache
+ *
+ * Keeps the output of previous compiles in memory, keyed by the entry and
+ * the options that affect output. An entry is only reused while every file
+ * in its `includedFiles` still has the same mtime and size. At most `max`
+ * entries are kept; the least recently used one is dropped first.
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+function Cache(options) {
+  this.max = options && options.max > 0 ? options.max : MAX_ENTRIES;
+  this.entries = {};
+  this.size = 0;
+}
+
+/**
+ * Get key
+ *
+ * @param {Object} options
+ * @api private
+ */
+
+Cache.prototype.key = function(options) {
+  var key = keyOptions.map(function(name) {
+    return options[name];
+  });
+
+  if (!options.file && options.data) {
+    key.push(crypto.createHash('md5').update(options.data).digest('hex'));
+  }
+
+  if (options.prelude) {
+    key.push(options.prelude.hash);
+  }
+
+  return JSON.stringify(key);
+};
+
+/**
+ * Get
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+Cache.prototype.get = function(options) {
+  var key = this.key(options);
+  var entry = this.entries[key];
+
+  if (!entry) {
+    return null;
+  }
+
+  var fresh = entry.includedFiles.every(function(file, i) {
+    return isCurrent(entry, i, statSignature(file));
+  });
+
+  return output(this.use(key, entry, fresh), options);
+};
+
+/**
+ * Lookup
+ *
+ * Like `get`, but checks the files asynchronously and calls `cb` with the
+ * entry or `null`, so a hit never blocks the event loop.
+ *
+ * @param {Object} options
+ * @param {Function} cb
+ * @api public
+ */
+
+Cache.prototype.lookup = function(options, cb) {
+  var self = this;
+  var key = this.key(options);
+  var entry = this.entries[key];
+
+  if (!entry) {
+    return cb(null);
+  }
+
+  statSignatures(entry.includedFiles, function(signatures) {
+    var fresh = signatures.every(function(signature, i) {
+      return isCurrent(entry, i, signature);
+    });
+
+    cb(output(self.use(key, entry, fresh), options));
+  });
+};
+
+/**
+ * Use
+ *
+ * Marks a fresh entry as the most recently used one, or drops a stale one
+ * unless it has been replaced in the meantime.
+ *
+ * @param {String} key
+ * @param {Object} entry
+ * @param {Boolean} fresh
+ * @api private
+ */
+
+Cache.prototype.use = function(key, entry, fresh) {
+  if (this.entries[key] !== entry) {
+    return fresh ? entry : null;
+  }
+
+  delete this.entries[key];
+
+  if (!fresh) {
+    this.size--;
+    return null;
+  }
+
+  // keys keep insertion order, so the first one is always the oldest
+  this.entries[key] = entry;
+  return entry;
+};
+
+/**
+ * Set
+ *
+ * Stores the output without touching the file system; whether the files
+ * it was compiled from are unchanged is checked by the lookups, against
+ * `start`, the time the compile started.
+ *
+ * @param {Object} options
+ * @param {String} css
+ * @param {String} sourceMap
+ * @param {Array} includedFiles
+ * @param {Number} start
+ * @api public
+ */
+
+Cache.prototype.set = function(options, css, sourceMap, includedFiles, start) {
+  var key = this.key(options);
+
+  if (this.entries[key]) {
+    delete this.entries[key];
+  } else {
+    this.size++;
+  }
+
+  this.entries[key] = {
+    css: css,
+    sourceMap: sourceMap,
+    includedFiles: (includedFiles || []).slice(),
+    files: [],
+    start: start
+  };
+
+  for (var oldest in this.entries) {
+    if (this.size <= this.max) {
+      break;
+    }
+
+    delete this.entries[oldest];
+    this.size--;
+  }
+};
+
+/**
+ * Store
+ *
+ * Like `set`, for compiles that must not block the loop. `set` does no
+ * I/O, so this only defers `cb`.
+ *
+ * @param {Object} options
+ * @param {String} css
+ * @param {String} sourceMap
+ * @param {Array} includedFiles
+ * @param {Number} start
+ * @param {Function} cb
+ * @api public
+ */
+
+Cache.prototype.store = function(options, css, sourceMap, includedFiles, start, cb) {
+  this.set(options, css, sourceMap, includedFiles, start);
+  process.nextTick(cb || function() {});
+};
+
+/**
+ * Clear
+ *
+ * @api public
+ */
+
+Cache.prototype.clear = function() {
+  this.entries = {};
+  this.size = 0;
+};
+
+/**
+ * Hash
+ *
+ * @param {String|Buffer} data
+ * @api private
+ */
+
+function hash(data) {
+  return crypto.createHash('sha1').update(data).digest('hex');
+}
+
+/**
+ * Parse manifest
+ *
+ * Returns the included files of a manifest, or `null` for one that is
+ * truncated or corrupt, which then counts as a miss.
+ *
+ * @param {String} manifest
+ * @api private
+ */
+
+function parseManifest(manifest) {
+  try {
+    var includedFiles = JSON.parse(manifest).includedFiles;
+    return Array.isArray(includedFiles) ? includedFiles : null;
+  } catch (err) {
+    return null;
+  }
+}
+
+/**
+ * Temporary files written by this process
+ */
+
+var temporaries = 0;
+
+/**
+ * Disk cache
+ *
+ * Content-addressed cache on disk, meant to be shared by repeated builds
+ * such as CI runs. A manifest per entry and options records which files
+ * the compile included; the output is stored under a hash of the options
+ * and the contents of all of those files, so a hit does not depend on
+ * mtimes surviving a fresh checkout.
+ *
+ * @param {String} dir
+ * @api public
+ */
+
+function DiskCache(dir) {
+  this.dir = path.resolve(dir);
+  mkdir.sync(this.dir);
+}
+
+DiskCache.prototype.key = Cache.prototype.key;
+
+/**
+ * Get output key
+ *
+ * Returns `null` if any of the files can no longer be read.
+ *
+ * @param {String} key
+ * @param {Array} files
+ * @api private
+ */
+
+DiskCache.prototype.outputKey = function(key, files) {
+  var hashes = [key];
+
+  for (var i = 0; i < files.length; i++) {
+    try {
+      hashes.push(files[i], hash(fs.readFileSync(files[i])));
+    } catch (err) {
+      return null;
+    }
+  }
+
+  return hash(hashes.join('\n'));
+};
+
+/**
+ * Hash files
+ *
+ * Like `outputKey`, but reads the files asynchronously. With `start`, a
+ * file modified after it also gives `null`, as it may have been read
+ * half-way through the compile.
+ *
+ * @param {String} key
+ * @param {Array} files
+ * @param {Number} start
+ * @param {Function} cb
+ * @api private
+ */
+
+function hashFiles(key, files, start, cb) {
+  var hashes = [];
+  var pending = files.length;
+  var failed = false;
+
+  function done() {
+    if (--pending === 0) {
+      cb(failed ? null : hash([key].concat(hashes).join('\n')));
+    }
+  }
+
+  if (!pending) {
+    return process.nextTick(function() {
+      cb(hash(key));
+    });
+  }
+
+  files.forEach(function(file, i) {
+    fs.stat(file, function(err, stat) {
+      if (err || (typeof start === 'number' && stat.mtime.getTime() >= start)) {
+        failed = true;
+        return done();
+      }
+
+      fs.readFile(file, function(err, data) {
+        failed = failed || Boolean(err);
+
+        if (!err) {
+          hashes[i * 2] = file;
+          hashes[i * 2 + 1] = hash(data);
+        }
+
+        done();
+      });
+    });
+  });
+}
+
+/**
+ * Read
+ *
+ * @param {String} name
+ * @api private
+ */
+
+DiskCache.prototype.read = function(name) {
+  try {
+    return fs.readFileSync(path.join(this.dir, name), 'utf8');
+  } catch (err) {
+    return null;
+  }
+};
+
+/**
+ * Write
+ *
+ * Writes through a temporary file so concurrent builds sharing the
+ * directory never read a partial entry.
+ *
+ * @param {String} name
+ * @param {String|Buffer} data
+ * @api private
+ */
+
+DiskCache.prototype.write = function(name, data) {
+  var file = path.join(this.dir, name);
+  var tmp = file + '.' + process.pid + '.' + (++temporaries) + '.tmp';
+
+  fs.writeFileSync(tmp, data);
+  fs.renameSync(tmp, file);
+};
+
+/**
+ * Write asynchronously
+ *
+ * @param {String} name
+ * @param {String|Buffer} data
+ * @param {Function} cb
+ * @api private
+ */
+
+DiskCache.prototype.writeFile = function(name, data, cb) {
+  var file = path.join(this.dir, name);
+  var tmp = file + '.' + process.pid + '.' + (++temporaries) + '.tmp';
+
+  fs.writeFile(tmp, data, function(err) {
+    if (err) {
+      return fs.unlink(tmp, function() {
+        cb(err);
+      });
+    }
+
+    fs.rename(tmp, file, cb);
+  });
+};
+
+/**
+ * Get
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+DiskCache.prototype.get = function(options) {
+  var key = this.key(options);
+  var manifest = this.read(hash(key) + '.json');
+
+  if (!manifest) {
+    return null;
+  }
+
+  var includedFiles = parseManifest(manifest);
+  var name = includedFiles && this.outputKey(key, includedFiles);
+  var css = name && this.read(name + '.css');
+
+  if (css === null || css === undefined) {
+    return null;
+  }
+
+  var sourceMap = this.read(name + '.map');
+
+  return output({ css: css, sourceMap: sourceMap, includedFiles: includedFiles }, options);
+};
+
+/**
+ * Lookup
+ *
+ * Like `get`, but reads and hashes the files asynchronously.
+ *
+ * @param {Object} options
+ * @param {Function} cb
+ * @api public
+ */
+
+DiskCache.prototype.lookup = function(options, cb) {
+  var dir = this.dir;
+  var key = this.key(options);
+
+  function read(name, encoding, done) {
+    fs.readFile(path.join(dir, name), encoding, function(err, data) {
+      done(err ? null : data);
+    });
+  }
+
+  read(hash(key) + '.json', 'utf8', function(manifest) {
+    var includedFiles = manifest && parseManifest(manifest);
+
+    if (!includedFiles) {
+      return cb(null);
+    }
+
+    hashFiles(key, includedFiles, null, function(name) {
+      if (!name) {
+        return cb(null);
+      }
+
+      read(name + '.css', 'utf8', function(css) {
+        if (css === null) {
+          return cb(null);
+        }
+
+        read(name + '.map', 'utf8', function(sourceMap) {
+          cb(output({ css: css, sourceMap: sourceMap, includedFiles: includedFiles }, options));
+        });
+      });
+    });
+  });
+};
+
+/**
+ * Set
+ *
+ * @param {Object} options
+ * @param {String|Buffer} css
+ * @param {String} sourceMap
+ * @param {Array} includedFiles
+ * @param {Number} start
+ * @api public
+ */
+
+DiskCache.prototype.set = function(options, css, sourceMap, includedFiles, start) {
+  var stale = (includedFiles || []).some(function(file) {
+    var signature = statSignature(file);
+    return !signature || signature.mtime >= start;
+  });
+
+  if (stale) {
+    return;
+  }
+
+  var key = this.key(options);
+  var name = this.outputKey(key, includedFiles);
+
+  if (!name) {
+    return;
+  }
+
+  this.write(name + '.css', css);
+
+  if (sourceMap) {
+    this.write(name + '.map', sourceMap);
+  }
+
+  this.write(hash(key) + '.json', JSON.stringify({ includedFiles: includedFiles }));
+};
+
+/**
+ * Store
+ *
+ * Like `set`, but stats, hashes and writes asynchronously. The manifest
+ * is written last, so a lookup never finds one without its output.
+ *
+ * @param {Object} options
+ * @param {String|Buffer} css
+ * @param {String} sourceMap
+ * @param {Array} includedFiles
+ * @param {Number} start
+ * @param {Function} cb
+ * @api public
+ */
+
+DiskCache.prototype.store = function(options, css, sourceMap, includedFiles, start, cb) {
+  var self = this;
+  var key = this.key(options);
+
+  includedFiles = includedFiles || [];
+  cb = cb || function() {};
+
+  hashFiles(key, includedFiles, start, function(name) {
+    if (!name) {
+      return cb();
+    }
+
+    self.writeFile(name + '.css', css, function(err) {
+      if (err) {
+        return cb(err);
+      }
+
+      function manifest(err) {
+        if (err) {
+          return cb(err);
+        }
+
+        self.writeFile(hash(key) + '.json', JSON.stringify({ includedFiles: includedFiles }), cb);
+      }
+
+      return sourceMap ? self.writeFile(name + '.map', sourceMap, manifest) : manifest();
+    });
+  });
+};
+
+/**
+ * Module exports
+ */
+
+module.exports = Cache;
+module.exports.DiskCache = DiskCache;
@@ -0,0 +1,109 @@
+var path = require('path');
+
+/**
+ * Normalize path
+ *
+ * libsass reports included files with forward slashes, so every path in
+ * the graph is stored resolved and in that form.
+ *
+ * @param {String} file
+ * @api private
+ */
+
+function normalize(file) {
+  return path.resolve(file).replace(/\\/g, '/');
+}
+
+/**
+ * Graph
+ *
+ * Reverse dependency graph from every included file to the entries whose
+ * last compile included it, built from `stats.includedFiles`.
+ *
+ * @api public
+ */
+
+function Graph() {
+  this.dependencies = {};
+  this.dependents = {};
+}
+
+/**
+ * Add
+ *
+ * Replaces the dependencies recorded for `entry`.
+ *
+ * @param {String} entry
+ * @param {Array} includedFiles
+ * @api public
+ */
+
+Graph.prototype.add = function(entry, includedFiles) {
+  entry = normalize(entry);
+  this.remove(entry);
+
+  var files = (includedFiles || []).map(normalize);
+
+  if (files.indexOf(entry) === -1) {
+    files.push(entry);
+  }
+
+  files.forEach(function(file) {
+    this.dependents[file] = this.dependents[file] || {};
+    this.dependents[file][entry] = true;
+  }, this);
+
+  this.dependencies[entry] = files;
+};
+
+/**
+ * Remove
+ *
+ * @param {String} entry
+ * @api public
+ */
+
+Graph.prototype.remove = function(entry) {
+  entry = normalize(entry);
+
+  (this.dependencies[entry] || []).forEach(function(file) {
+    delete this.dependents[file][entry];
+
+    if (!Object.keys(this.dependents[file]).length) {
+      delete this.dependents[file];
+    }
+  }, this);
+
+  delete this.dependencies[entry];
+};
+
+/**
+ * Get entries
+ *
+ * Returns every entry that has to be recompiled when `file` changes.
+ *
+ * @param {String} file
+ * @api public
+ */
+
+Graph.prototype.getEntries = function(file) {
+  return Object.keys(this.dependents[normalize(file)] || {});
+};
+
+/**
+ * Get files
+ *
+ * Returns every file some entry in the graph depends on.
+ *
+ * @api public
+ */
+
+Graph.prototype.getFiles = function() {
+  return Object.keys(this.dependents);
+};
+
+/**
+ * Module exports
+ */
+
+module.exports = Graph;
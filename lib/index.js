@@ -1,5 +1,12 @@
-var fs = require('fs'),
-    path = require('path');
+var crypto = require('crypto'),
+    fs = require('fs'),
+    os = require('os'),
+    path = require('path'),
+    Transform = require('stream').Transform,
+    assign = require('object-assign'),
+    Cache = require('./cache'),
+    Tracer = require('./trace'),
+    renderParallel = require('./parallel');
 
 /**
  * Get binding
@@ -47,6 +54,12 @@ function getOutFile(options) {
   return path.resolve(path.dirname(file), outFile);
 }
 
+/**
+ * Active tracer, see `startTracing()`
+ */
+
+var tracer = null;
+
 /**
  * Get stats
  *
@@ -55,14 +68,58 @@ function getOutFile(options) {
  */
 
 function getStats(options) {
+  // the cache needs `includedFiles` even when the caller doesn't
+  options.collectStats = options.stats !== false || Boolean(getCache(options));
+  options.stats = options.stats || {};
+
   var stats = options.stats;
 
   stats.entry = options.file || 'data';
   stats.start = Date.now();
+  delete stats.cached;
+  delete stats.trace;
+
+  options.trace = Boolean(tracer);
 
   return stats;
 }
 
+/**
+ * Trace stats
+ *
+ * @param {Object} stats
+ * @api private
+ */
+
+function traceStats(stats) {
+  // an async trace is only complete once its callback has returned
+  if (tracer && stats.trace && stats.trace.length > 7) {
+    tracer.add(stats);
+  }
+}
+
+/**
+ * End trace
+ *
+ * The binding can't time the callback of an async compile it is still
+ * running, so its end is taken here once the callback has returned, on the
+ * same clock.
+ *
+ * @param {Object} stats
+ * @api private
+ */
+
+function endTrace(stats) {
+  var trace = stats.trace;
+
+  if (trace && trace.length === 7) {
+    var time = process.hrtime();
+    trace.push(time[0] * 1e6 + time[1] / 1e3);
+  }
+
+  traceStats(stats);
+}
+
 /**
  * End stats
  *
@@ -76,28 +133,141 @@ function endStats(options, sourceMap) {
 
   stats.end = Date.now();
   stats.duration = stats.end - stats.start;
-  stats.sourceMap = sourceMap;
+  setSourceMap(stats, sourceMap);
+  setIncludedFiles(stats);
+  traceStats(stats);
 
   return stats;
 }
 
+/**
+ * Set included files
+ *
+ * The binding passes `includedFiles` as a single string of sorted, unique
+ * paths separated by NUL; `stats.includedFiles` only splits it into an
+ * array the first time it is read.
+ *
+ * @param {Object} stats
+ * @api private
+ */
+
+function setIncludedFiles(stats) {
+  var descriptor = Object.getOwnPropertyDescriptor(stats, 'includedFiles');
+  var value = descriptor && descriptor.value;
+
+  // already lazy from an earlier compile with the same stats object
+  if (!descriptor || descriptor.get) {
+    return;
+  }
+
+  Object.defineProperty(stats, 'includedFiles', {
+    configurable: true,
+    enumerable: true,
+    get: function() {
+      if (typeof value === 'string') {
+        value = value ? value.split('\0') : [];
+      }
+
+      return value;
+    },
+    set: function(includedFiles) {
+      value = includedFiles;
+    }
+  });
+}
+
+/**
+ * Set source map
+ *
+ * The binding hands source maps over as a `Buffer`; `stats.sourceMap` only
+ * decodes it into a string the first time it is read.
+ *
+ * @param {Object} stats
+ * @param {Buffer|String} sourceMap
+ * @api private
+ */
+
+function setSourceMap(stats, sourceMap) {
+  var value = sourceMap;
+
+  Object.defineProperty(stats, 'sourceMap', {
+    configurable: true,
+    enumerable: true,
+    get: function() {
+      if (Buffer.isBuffer(value)) {
+        value = value.toString();
+      }
+
+      return value;
+    },
+    set: function(sourceMap) {
+      value = sourceMap;
+    }
+  });
+}
+
+/**
+ * Output styles, in the order of their libsass values
+ */
+
+var styleNames = ['nested', 'expanded', 'compact', 'compressed'];
+
 /**
  * Get style
  *
+ * @param {String} style
+ * @api private
+ */
+
+function getStyle(style) {
+  var index = styleNames.indexOf(style);
+
+  return index === -1 ? 0 : index;
+}
+
+/**
+ * Get styles
+ *
+ * An array of output styles is compiled in a single job; the results are
+ * then objects keyed by style.
+ *
  * @param {Object} options
  * @api private
  */
 
-function getStyle(options) {
+function getStyles(options) {
   var style = options.output_style || options.outputStyle;
-  var styles = {
-    nested: 0,
-    expanded: 1,
-    compact: 2,
-    compressed: 3
-  };
 
-  return styles[style];
+  if (!Array.isArray(style) || !style.length) {
+    return null;
+  }
+
+  return style.map(getStyle).filter(function(index, i, styles) {
+    return styles.indexOf(index) === i;
+  });
+}
+
+/**
+ * By style
+ *
+ * Keys the results of a multi-style compile by style name.
+ *
+ * @param {Array} styles
+ * @param {Array} values
+ * @param {Boolean} decode
+ * @api private
+ */
+
+function byStyle(styles, values, decode) {
+  var result = {};
+
+  styles.forEach(function(style, i) {
+    var value = values ? values[i] : null;
+
+    result[styleNames[style]] = decode && Buffer.isBuffer(value) ? value.toString() : value;
+  });
+
+  return result;
 }
 
 /**
@@ -124,176 +294,1046 @@ function getSourceMap(options) {
 }
 
 /**
- * Get options
+ * Disk caches by directory
+ */
+
+var diskCaches = {};
+
+/**
+ * Get cache
  *
  * @param {Object} options
  * @api private
  */
 
-function getOptions(options) {
-  options = options || {};
-  options.comments = options.source_comments || options.sourceComments || false;
-  options.data = options.data || null;
-  options.file = options.file || null;
-  options.imagePath = options.image_path || options.imagePath || '';
-  options.outFile = getOutFile(options) || null;
-  options.paths = (options.include_paths || options.includePaths || []).join(path.delimiter);
-  options.precision = parseInt(options.precision) || 5;
-  options.sourceMap = getSourceMap(options);
-  options.stats = options.stats || {};
-  options.style = getStyle(options) || 0;
-
-  if (options.imagePath && typeof options.imagePath !== 'string') {
-    throw new Error('`imagePath` needs to be a string');
+function getCache(options) {
+  // multi-style results are not stored
+  if (options.styles) {
+    return null;
   }
 
-  getStats(options);
-
-  var error = options.error;
-  var success = options.success;
-
-  options.error = function(err, code) {
-    if (error) {
-      error(err, code);
-    }
-  };
+  if (options.cache === true) {
+    return module.exports.cache;
+  }
 
-  options.success = function(css, sourceMap) {
-    endStats(options, sourceMap);
+  if (options.cache instanceof Cache || options.cache instanceof Cache.DiskCache) {
+    return options.cache;
+  }
 
-    if (success) {
-      success(css, sourceMap);
-    }
-  };
+  if (options.cacheDir) {
+    var dir = path.resolve(options.cacheDir);
 
-  delete options.image_path;
-  delete options.include_paths;
-  delete options.includePaths;
-  delete options.source_comments;
-  delete options.sourceComments;
+    diskCaches[dir] = diskCaches[dir] || new Cache.DiskCache(dir);
+    return diskCaches[dir];
+  }
 
-  return options;
+  return null;
 }
 
 /**
- * Require binding
+ * Read cache
+ *
+ * Returns the cached result of an identical earlier compile whose included
+ * files are unchanged and fills `stats` from it.
+ *
+ * @param {Object} options
+ * @api private
  */
 
-var binding = require(getBinding());
+function readCache(options) {
+  var cache = getCache(options);
+
+  return useCache(options, cache && cache.get(options));
+}
 
 /**
- * Render (deprecated)
+ * Lookup cache
+ *
+ * Like `readCache`, but without blocking the event loop on the checks of
+ * a hit. Without a cache, `cb` is called right away.
  *
- * @param {String} css
- * @param {Function} cb
  * @param {Object} options
+ * @param {Function} cb
  * @api private
  */
 
-function deprecatedRender(css, cb, options) {
-  options = getOptions(options);
-  options.data = css;
-  options.error = cb;
-  options.success = function(css) {
-    cb(null, css);
-  };
+function lookupCache(options, cb) {
+  var cache = getCache(options);
 
-  binding.render(options);
+  if (!cache) {
+    return cb(null);
+  }
+
+  cache.lookup(options, function(entry) {
+    cb(useCache(options, entry));
+  });
 }
 
 /**
- * Render sync (deprecated)
+ * Use cache
  *
- * @param {String} css
  * @param {Object} options
+ * @param {Object} entry
  * @api private
  */
 
-function deprecatedRenderSync(css, options) {
-  options = getOptions(options);
-  options.data = css;
+function useCache(options, entry) {
+  if (entry) {
+    options.stats.cached = true;
+    options.stats.includedFiles = entry.includedFiles.slice();
+    options.stats.sourceMap = entry.sourceMap;
+  }
 
-  return binding.renderSync(options);
+  return entry;
 }
 
 /**
- * Render
+ * Write cache
+ *
+ * Only `renderSync` stores synchronously; async compiles check, hash and
+ * write with async fs calls so storing never blocks the loop.
  *
  * @param {Object} options
- * @api public
+ * @param {String} css
+ * @param {String} sourceMap
+ * @param {Boolean} sync
+ * @api private
  */
 
-module.exports.render = function(options) {
-  if (typeof arguments[0] === 'string') {
-    return deprecatedRender.apply(this, arguments);
+function writeCache(options, css, sourceMap, sync) {
+  var cache = getCache(options);
+
+  if (!cache || options.stats.cached) {
+    return;
   }
 
-  options = getOptions(options);
-  options.file ? binding.renderFile(options) : binding.render(options);
-};
+  var includedFiles = options.stats.includedFiles;
+  var start = options.stats.start;
+
+  if (sync) {
+    return cache.set(options, css, sourceMap, includedFiles, start);
+  }
+
+  if (css !== null) {
+    return cache.store(options, css, sourceMap, includedFiles, start);
+  }
+
+  // output the worker wrote itself is read back from disk, off the loop
+  if (options.writeToDisk) {
+    fs.readFile(options.writeToDisk.css, function(err, written) {
+      if (err) {
+        return;
+      }
+
+      if (!options.writeToDisk.sourceMap) {
+        return cache.store(options, written, null, includedFiles, start);
+      }
+
+      fs.readFile(options.writeToDisk.sourceMap, 'utf8', function(mapError, map) {
+        cache.store(options, written, mapError ? null : map, includedFiles, start);
+      });
+    });
+  }
+}
 
 /**
- * Render sync
+ * Get callbacks
+ *
+ * Starts `stats` and wraps `success` and `error` so both are optional.
  *
  * @param {Object} options
- * @api public
+ * @api private
  */
 
-module.exports.renderSync = function(options) {
-  if (typeof arguments[0] === 'string') {
-    return deprecatedRenderSync.apply(this, arguments);
-  }
+function getCallbacks(options) {
+  getStats(options);
 
-  var output;
+  var error = options.error;
+  var success = options.success;
 
-  options = getOptions(options);
-  output = options.file ? binding.renderFileSync(options) : binding.renderSync(options);
+  options.error = function(err, code, details) {
+    setIncludedFiles(options.stats);
 
-  endStats(options, options.stats.sourceMap);
-  return output;
-};
+    try {
+      if (error) {
+        error(err, code, details);
+      }
+    } finally {
+      endTrace(options.stats);
+    }
+  };
+
+  options.success = function(css, sourceMap) {
+    if (options.styles && Array.isArray(css)) {
+      css = byStyle(options.styles, css);
+      sourceMap = byStyle(options.styles, sourceMap, !options.outputBuffer);
+    }
+
+    endStats(options, sourceMap);
+    writeCache(options, css, sourceMap);
+
+    if (!success) {
+      return endTrace(options.stats);
+    }
+
+    try {
+      // compiles that asked for no map leave `stats.sourceMap` unread
+      success(css, options.outputBuffer ? sourceMap : options.sourceMap ? options.stats.sourceMap : undefined);
+    } finally {
+      endTrace(options.stats);
+    }
+  };
+
+  return options;
+}
 
 /**
- * Render file
- *
- * `options.sourceMap` can be used to specify that the source map should be saved:
+ * Get handle
  *
- * - If falsy the source map will not be saved
- * - If `options.sourceMap === true` the source map will be saved to the
- *   standard location of `options.file + '.map'`
- * - Else `options.sourceMap` specifies the path (relative to the `outFile`)
- *   where the source map should be saved
+ * Makes an async compile cancellable. `cancel()` drops the compile if no
+ * thread has picked it up yet and reports it to `options.error` with the
+ * status `'ECANCELED'`; a compile that has already started runs to the end,
+ * but its result is discarded and its output is not written to disk.
+ * `options.timeout` cancels the compile after that many milliseconds with
+ * the status `'ETIMEDOUT'`.
  *
  * @param {Object} options
- * @api public
+ * @api private
  */
 
-module.exports.renderFile = function(options) {
-  options = options || {};
-
-  var outFile = options.outFile;
+function getHandle(options) {
+  var error = options.error;
   var success = options.success;
+  var finished = false;
+  var timer;
 
-  if (options.sourceMap === true) {
-    options.sourceMap = outFile + '.map';
+  function finish() {
+    finished = handle.finished = true;
+    clearTimeout(timer);
   }
 
+  options.error = function(err, code, details) {
+    if (!finished) {
+      finish();
+      error(err, code, details);
+    }
+  };
+
   options.success = function(css, sourceMap) {
-    fs.writeFile(outFile, css, function(err) {
-      if (err) {
-        return options.error(err);
-      }
+    if (!finished) {
+      finish();
+      success(css, sourceMap);
+    }
+  };
 
-      if (!options.sourceMap) {
-        return success(outFile);
-      }
+  function abort(message, status) {
+    if (finished) {
+      return false;
+    }
+
+    if (handle.id !== null) {
+      binding.cancel(handle.id);
+    }
+
+    options.error(message, status);
+    return true;
+  }
+
+  var handle = {
+    id: null,
+    finished: false,
+    cancel: function() {
+      return abort('Compile cancelled', 'ECANCELED');
+    }
+  };
+
+  if (options.timeout > 0) {
+    timer = setTimeout(function() {
+      abort('Compile timed out after ' + options.timeout + 'ms', 'ETIMEDOUT');
+    }, options.timeout);
+  }
+
+  return handle;
+}
+
+/**
+ * Options that are given per call rather than to `createOptions()`
+ */
+
+var callOptions = [
+  'cache',
+  'cacheDir',
+  'collectStats',
+  'error',
+  'maxMemory',
+  'outputBuffer',
+  'stats',
+  'success',
+  'timeout',
+  'trace',
+  'writeToDisk'
+];
+
+/**
+ * Get compiled options
+ *
+ * Per-call options inherit everything from options made by
+ * `createOptions()` and only carry their own `callOptions`.
+ *
+ * @param {Object} options
+ * @api private
+ */
+
+function getCompiledOptions(options) {
+  var compiled = options.compiled instanceof binding.CompiledOptions ? options : options.compiled;
+  var call = Object.create(compiled);
 
-      var dir = path.dirname(outFile);
-      var sourceMapFile = path.resolve(dir, options.sourceMap);
+  callOptions.forEach(function(name) {
+    call[name] = options[name];
+  });
+
+  return getCallbacks(call);
+}
+
+/**
+ * Get prelude
+ *
+ * Puts the include paths of `options.prelude` ahead of the compile's own.
+ *
+ * @param {Object} options
+ * @api private
+ */
+
+function getPrelude(options) {
+  var prelude = options.prelude;
+
+  if (!prelude) {
+    return;
+  }
+
+  if (!(prelude instanceof binding.Prelude)) {
+    throw new Error('`prelude` needs to be made by `createPrelude()`');
+  }
+
+  if (options.file) {
+    throw new Error('`prelude` only applies to `data` compiles');
+  }
+
+  options.includePaths = prelude.includePaths.concat(options.include_paths || options.includePaths || []);
+  delete options.include_paths;
+}
+
+/**
+ * Get options
+ *
+ * @param {Object} options
+ * @api private
+ */
+
+function getOptions(options) {
+  if (options && options.compiled) {
+    return getCompiledOptions(options);
+  }
+
+  options = options || {};
+  getPrelude(options);
+  options.comments = options.source_comments || options.sourceComments || false;
+  options.data = options.data || null;
+  options.file = options.file || null;
+  options.imagePath = options.image_path || options.imagePath || '';
+  options.outFile = getOutFile(options) || null;
+  // repeats only make libsass probe the same directory again
+  options.paths = (options.include_paths || options.includePaths || []).filter(function(dir, i, paths) {
+    return dir && paths.indexOf(dir) === i;
+  }).join(path.delimiter);
+  options.precision = parseInt(options.precision) || 5;
+  options.sourceMap = getSourceMap(options);
+  options.styles = getStyles(options);
+  options.style = options.styles ? options.styles[0] || 0 : getStyle(options.output_style || options.outputStyle);
+
+  if (options.imagePath && typeof options.imagePath !== 'string') {
+    throw new Error('`imagePath` needs to be a string');
+  }
+
+  getCallbacks(options);
+
+  delete options.image_path;
+  delete options.include_paths;
+  delete options.includePaths;
+  delete options.source_comments;
+  delete options.sourceComments;
+
+  return options;
+}
+
+/**
+ * Require binding
+ */
+
+var binding = require(getBinding());
+
+/**
+ * Size the compile pool to the machine; threads are only spawned once the
+ * first async compile is queued
+ */
+
+binding.setConcurrency(os.cpus().length);
+
+/**
+ * Single style
+ *
+ * APIs that write their output somewhere only take one output style.
+ *
+ * @param {Object} options
+ * @param {String} api
+ * @api private
+ */
+
+function singleStyle(options, api) {
+  if (options && Array.isArray(options.output_style || options.outputStyle)) {
+    throw new Error('`' + api + '` only supports a single `outputStyle`');
+  }
+}
+
+/**
+ * Render (deprecated)
+ *
+ * @param {String} css
+ * @param {Function} cb
+ * @param {Object} options
+ * @api private
+ */
+
+function deprecatedRender(css, cb, options) {
+  options = getOptions(options);
+  options.data = css;
+  options.error = cb;
+  options.success = function(css) {
+    cb(null, css);
+  };
+
+  binding.render(options);
+}
+
+/**
+ * Render sync (deprecated)
+ *
+ * @param {String} css
+ * @param {Object} options
+ * @api private
+ */
+
+function deprecatedRenderSync(css, options) {
+  options = getOptions(options);
+  options.data = css;
+
+  return binding.renderSync(options);
+}
+
+/**
+ * Render
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+module.exports.render = function(options) {
+  if (typeof arguments[0] === 'string') {
+    return deprecatedRender.apply(this, arguments);
+  }
+
+  if (options && options.parallelImports && options.file) {
+    return renderParallel(options);
+  }
+
+  options = getOptions(options);
+
+  var handle = getHandle(options);
+
+  lookupCache(options, function(cached) {
+    if (cached) {
+      return options.success(cached.css, cached.sourceMap);
+    }
+
+    // cancelled or timed out while the cache was checked
+    if (!handle.finished) {
+      handle.id = options.file ? binding.renderFile(options) : binding.render(options);
+    }
+  });
+
+  return { cancel: handle.cancel };
+};
+
+/**
+ * Render sync
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+module.exports.renderSync = function(options) {
+  if (typeof arguments[0] === 'string') {
+    return deprecatedRenderSync.apply(this, arguments);
+  }
+
+  var output;
+
+  options = getOptions(options);
+
+  var cached = readCache(options);
+
+  if (cached) {
+    endStats(options, cached.sourceMap);
+    return cached.css;
+  }
+
+  try {
+    output = options.file ? binding.renderFileSync(options) : binding.renderSync(options);
+  } catch (err) {
+    setIncludedFiles(options.stats);
+    traceStats(options.stats);
+    throw err;
+  }
+
+  var sourceMap = options.stats.sourceMap;
+
+  if (options.styles && Array.isArray(output)) {
+    output = byStyle(options.styles, output);
+    sourceMap = byStyle(options.styles, sourceMap, !options.outputBuffer);
+  }
+
+  endStats(options, sourceMap);
+  writeCache(options, output, sourceMap, true);
+  return output;
+};
+
+/**
+ * Render stream
+ *
+ * Returns a transform stream that compiles the Sass source written to it.
+ * Chunks are appended to a native buffer as they arrive, so the source is
+ * never joined into a JS string, and the compile starts once the input
+ * ends. The CSS is pushed to the readable side as a Buffer unless
+ * `outputBuffer` is `false`.
+ *
+ * Errors are emitted on the stream unless an `error` callback is given;
+ * `success` is still called with the CSS and source map if present.
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+module.exports.renderStream = function(options) {
+  var source = new binding.SourceBuffer();
+  var stream = new Transform();
+  var success = options && options.success;
+  var error = options && options.error;
+  var flushed;
+
+  singleStyle(options, 'renderStream');
+
+  options = assign({ outputBuffer: true }, options, {
+    success: function(css, sourceMap) {
+      if (css !== null) {
+        stream.push(css);
+      }
+
+      if (success) {
+        success(css, sourceMap);
+      }
+
+      flushed();
+    },
+    error: function(err, status, details) {
+      if (error) {
+        error(err, status, details);
+        return flushed();
+      }
+
+      flushed(new Error(err));
+    }
+  });
+
+  // the source is only known once it has been read, so it can't be keyed
+  delete options.cache;
+  delete options.cacheDir;
+  delete options.compiled;
+  delete options.file;
+
+  options = getOptions(options);
+  stream.stats = options.stats;
+
+  stream._transform = function(chunk, encoding, done) {
+    source.write(chunk);
+    done();
+  };
+
+  stream._flush = function(done) {
+    flushed = done;
+    options.data = source;
+    binding.render(options);
+  };
+
+  return stream;
+};
+
+/**
+ * Render batch
+ *
+ * Compiles every entry of `batch` with a single call into the binding.
+ * Per-item `success` and `error` callbacks are still honoured; `cb` is
+ * called once all entries have finished with an array of results in the
+ * same order as `batch`. Each result is either `{ css, sourceMap, stats }`
+ * or `{ error, status, stats }`.
+ *
+ * @param {Array} batch
+ * @param {Function} cb
+ * @api public
+ */
+
+module.exports.renderBatch = function(batch, cb) {
+  var results = new Array(batch.length);
+  var pending = batch.length;
+  var firstError = null;
+
+  if (!pending) {
+    return process.nextTick(function() {
+      cb(null, results);
+    });
+  }
+
+  function done() {
+    if (--pending === 0) {
+      cb(firstError, results);
+    }
+  }
+
+  var entries = batch.map(function(options, i) {
+    options = getOptions(options);
+
+    var error = options.error;
+    var success = options.success;
+
+    // an entry's callback that throws still counts the entry as done, so
+    // the batch callback is called before the exception propagates
+    options.error = function(err, code, details) {
+      results[i] = { error: err, status: code, details: details, stats: options.stats };
+      firstError = firstError || err;
+
+      try {
+        error(err, code, details);
+      } finally {
+        done();
+      }
+    };
+
+    options.success = function(css, sourceMap) {
+      results[i] = { css: css, sourceMap: sourceMap, stats: options.stats };
+
+      try {
+        success(css, sourceMap);
+      } finally {
+        done();
+      }
+    };
+
+    return { options: options, handle: getHandle(options), cached: null };
+  });
+
+  // every miss still goes to the binding in one call, once all entries
+  // have been looked up; without caches that happens right away
+  function submit() {
+    var queued = entries.filter(function(entry) {
+      return !entry.cached && !entry.handle.finished;
+    });
+
+    binding.renderBatch(queued.map(function(entry) {
+      return entry.options;
+    })).forEach(function(id, i) {
+      queued[i].handle.id = id;
+    });
+
+    entries.forEach(function(entry) {
+      if (entry.cached) {
+        entry.options.success(entry.cached.css, entry.cached.sourceMap);
+      }
+    });
+  }
+
+  var lookups = entries.length;
+
+  entries.forEach(function(entry) {
+    lookupCache(entry.options, function(cached) {
+      entry.cached = cached;
+
+      if (--lookups === 0) {
+        submit();
+      }
+    });
+  });
+
+  return {
+    cancel: function() {
+      entries.forEach(function(entry) {
+        entry.handle.cancel();
+      });
+    }
+  };
+};
+
+/**
+ * Set concurrency
+ *
+ * Sets the number of threads in the native compile pool used by `render`,
+ * `renderFile` and `renderBatch`. Defaults to the number of CPUs.
+ *
+ * @param {Number} size
+ * @api public
+ */
+
+module.exports.setConcurrency = function(size) {
+  size = parseInt(size, 10);
+
+  if (!(size > 0)) {
+    throw new Error('`concurrency` needs to be a positive integer');
+  }
+
+  binding.setConcurrency(size);
+};
+
+/**
+ * Get concurrency
+ *
+ * @api public
+ */
+
+module.exports.getConcurrency = function() {
+  return binding.getConcurrency();
+};
+
+/**
+ * Submission queue for `renderAsync`
+ *
+ * At most `limit` compiles are handed to the binding at once; the rest wait
+ * here as plain options, before any native context or callback is
+ * allocated for them.
+ */
+
+var queue = {
+  limit: 256,
+  overflow: 'wait',
+  active: 0,
+  waiting: []
+};
+
+/**
+ * Set queue limit
+ *
+ * `overflow` is either `'wait'`, to hold further submissions until a
+ * compile finishes, or `'reject'`, to reject them straight away.
+ *
+ * @param {Number} limit
+ * @param {String} overflow
+ * @api public
+ */
+
+module.exports.setQueueLimit = function(limit, overflow) {
+  if (limit !== Infinity) {
+    limit = parseInt(limit, 10);
+  }
+
+  if (!(limit > 0)) {
+    throw new Error('`limit` needs to be a positive integer');
+  }
+
+  if (overflow && overflow !== 'wait' && overflow !== 'reject') {
+    throw new Error('`overflow` needs to be either `wait` or `reject`');
+  }
+
+  queue.limit = limit;
+  queue.overflow = overflow || queue.overflow;
+  drainQueue();
+};
+
+/**
+ * Drain queue
+ *
+ * @api private
+ */
+
+function drainQueue() {
+  while (queue.waiting.length && queue.active < queue.limit) {
+    submit(queue.waiting.shift());
+  }
+}
+
+/**
+ * Submit
+ *
+ * @param {Object} job
+ * @api private
+ */
+
+function submit(job) {
+  var options = assign({}, job.options);
+  var deferMap = options.deferSourceMap === true;
+
+  queue.active++;
+  delete options.deferSourceMap;
+
+  options.stats = options.stats === false ? false : options.stats || {};
+  options.success = function(css, sourceMap) {
+    queue.active--;
+    job.resolve({
+      css: css,
+      // the same map, or `null` for compiles that produced none
+      sourceMap: deferMap ? module.exports.Promise.resolve(sourceMap || null) : sourceMap,
+      stats: options.stats
+    });
+    drainQueue();
+  };
+
+  options.error = function(message, status, details) {
+    var err = message instanceof Error ? message : new Error(message);
+
+    err.status = status;
+
+    if (details) {
+      err.file = details.file;
+      err.line = details.line;
+      err.column = details.column;
+      err.backtrace = details.backtrace;
+    }
+
+    queue.active--;
+    job.reject(err);
+    drainQueue();
+  };
+
+  try {
+    module.exports.render(options);
+  } catch (err) {
+    options.error(err);
+  }
+}
+
+/**
+ * Promise implementation used by `renderAsync`
+ *
+ * @api public
+ */
+
+module.exports.Promise = global.Promise;
+
+/**
+ * Render async
+ *
+ * Returns a promise for `{ css, sourceMap, stats }`, rejected with an
+ * `Error` carrying the libsass `status` and, for compile errors, the
+ * `file`, `line`, `column` and `backtrace` of the structured error.
+ * Submissions are bounded by `setQueueLimit()`.
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+module.exports.renderAsync = function(options) {
+  var P = module.exports.Promise;
+
+  if (!P) {
+    throw new Error('`renderAsync` needs a Promise implementation; set `sass.Promise`');
+  }
+
+  return new P(function(resolve, reject) {
+    var job = { options: options || {}, resolve: resolve, reject: reject };
+
+    if (queue.active < queue.limit) {
+      return submit(job);
+    }
+
+    if (queue.overflow === 'reject') {
+      var err = new Error('Compile queue is full (' + queue.limit + ' in flight)');
+
+      err.status = 'EQUEUEFULL';
+      return reject(err);
+    }
+
+    queue.waiting.push(job);
+  });
+};
+
+/**
+ * Create options
+ *
+ * Normalizes `options` and marshals them into native form once. The result
+ * is immutable and can be reused for any number of compiles by passing it
+ * as `compiled`, together with per-call `success`, `error` and `stats`:
+ *
+ *     var compiled = sass.createOptions({ file: 'theme.scss' });
+ *     sass.render({ compiled: compiled, success: function(css) {} });
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+module.exports.createOptions = function(options) {
+  var compiled = getOptions(assign({}, options));
+
+  callOptions.forEach(function(name) {
+    delete compiled[name];
+  });
+
+  compiled.compiled = new binding.CompiledOptions(compiled);
+
+  return Object.freeze(compiled);
+};
+
+/**
+ * Start tracing
+ *
+ * Records trace events for every compile from now on, into `t` or a new
+ * `Tracer`, which is returned.
+ *
+ * @param {Tracer} t
+ * @api public
+ */
+
+module.exports.startTracing = function(t) {
+  tracer = t || new Tracer();
+  return tracer;
+};
+
+/**
+ * Stop tracing
+ *
+ * Returns the tracer that was active, if any.
+ *
+ * @api public
+ */
+
+module.exports.stopTracing = function() {
+  var t = tracer;
+
+  tracer = null;
+  return t;
+};
+
+module.exports.Tracer = Tracer;
+
+/**
+ * Native directory watcher, wrapped by `lib/watcher`
+ *
+ * @api private
+ */
+
+module.exports.FileWatcher = binding.Watcher;
+
+/**
+ * Create prelude
+ *
+ * Reads the source every compile of a set starts with, e.g. the imports
+ * and settings of a framework, into native memory once. Compiles given it
+ * as `prelude` only pass their own `data`, which is compiled as if it
+ * followed the prelude:
+ *
+ *     var prelude = sass.createPrelude({ file: 'framework.scss' });
+ *     sass.render({ prelude: prelude, data: '$brand: red;', success: fn });
+ *
+ * A prelude from `file` resolves its imports relative to that file.
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+module.exports.createPrelude = function(options) {
+  options = options || {};
+
+  var source = options.data;
+  var includePaths = [].concat(options.include_paths || options.includePaths || []);
+
+  if (options.file) {
+    source = fs.readFileSync(options.file, 'utf8');
+    includePaths.unshift(path.dirname(path.resolve(options.file)));
+  }
+
+  if (typeof source !== 'string') {
+    throw new Error('`createPrelude` needs `data` or `file`');
+  }
+
+  var prelude = new binding.Prelude(source);
+
+  prelude.includePaths = includePaths;
+  prelude.hash = crypto.createHash('md5').update(source).update(includePaths.join(path.delimiter)).digest('hex');
+
+  return Object.freeze(prelude);
+};
+
+/**
+ * Process-wide compile cache, used when `options.cache === true`
+ *
+ * @api public
+ */
+
+module.exports.Cache = Cache;
+module.exports.cache = new Cache();
+
+/**
+ * Render file
+ *
+ * `options.sourceMap` can be used to specify that the source map should be saved:
+ *
+ * - If falsy the source map will not be saved
+ * - If `options.sourceMap === true` the source map will be saved to the
+ *   standard location of `options.file + '.map'`
+ * - Else `options.sourceMap` specifies the path (relative to the `outFile`)
+ *   where the source map should be saved
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+module.exports.renderFile = function(options) {
+  options = options || {};
+  singleStyle(options, 'renderFile');
+
+  var outFile = options.outFile;
+  var success = options.success;
+  var error = options.error || function() {};
+  var sourceMapFile;
+
+  if (options.sourceMap === true) {
+    options.sourceMap = outFile + '.map';
+  }
+
+  if (options.sourceMap) {
+    sourceMapFile = path.resolve(path.dirname(outFile), options.sourceMap);
+  }
+
+  // the binding writes both files from its worker thread; CSS only reaches
+  // JS for results served from the cache
+  options.writeToDisk = { css: outFile, sourceMap: sourceMapFile };
+
+  if (options.outputBuffer === undefined) {
+    options.outputBuffer = true;
+  }
+
+  options.success = function(css, sourceMap) {
+    if (css === null) {
+      return success(outFile, sourceMapFile);
+    }
+
+    fs.writeFile(outFile, css, function(err) {
+      if (err) {
+        return error(err);
+      }
+
+      if (!sourceMapFile) {
+        return success(outFile);
+      }
 
       fs.writeFile(sourceMapFile, sourceMap, function(err) {
         if (err) {
-          return options.error(err);
+          return error(err);
         }
 
         success(outFile, sourceMapFile);
@@ -301,7 +1341,7 @@ module.exports.renderFile = function(options) {
     });
   };
 
-  module.exports.render(options);
+  return module.exports.render(options);
 };
 
 /**
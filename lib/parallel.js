@@ -0,0 +1,265 @@
+var fs = require('fs'),
+    path = require('path'),
+    assign = require('object-assign'),
+    sass = require('./');
+
+/**
+ * Get imports
+ *
+ * Returns the URLs of the entry's top-level `@import`s, or `null` unless
+ * the entry consists of nothing else.
+ *
+ * @param {String} source
+ * @api private
+ */
+
+function getImports(source) {
+  var statements = source
+    .replace(/\/\*[\s\S]*?\*\//g, '')
+    .replace(/\/\/.*$/gm, '')
+    .split(';');
+  var imports = [];
+
+  for (var i = 0; i < statements.length; i++) {
+    var statement = statements[i].trim();
+    var match = /^@import\s+([\s\S]+)$/.exec(statement);
+
+    if (!statement) {
+      continue;
+    }
+
+    if (!match) {
+      return null;
+    }
+
+    var urls = match[1].split(',');
+
+    for (var j = 0; j < urls.length; j++) {
+      var url = /^(['"])([^'"]+)\1$/.exec(urls[j].trim());
+
+      // plain CSS imports are left to libsass
+      if (!url || /\.css$|^(https?:)?\/\//.test(url[2])) {
+        return null;
+      }
+
+      imports.push(url[2]);
+    }
+  }
+
+  return imports.length ? imports : null;
+}
+
+/**
+ * Import statement
+ *
+ * @param {String} url
+ * @api private
+ */
+
+function importStatement(url) {
+  return '@import "' + url.replace(/"/g, '\\"') + '";\n';
+}
+
+/**
+ * Can split
+ *
+ * @param {Object} options
+ * @api private
+ */
+
+function canSplit(options) {
+  var style = options.output_style || options.outputStyle;
+
+  return !options.sourceMap && !options.indentedSyntax &&
+    !Array.isArray(style) && /\.scss$/.test(options.file);
+}
+
+/**
+ * Render parallel
+ *
+ * Compiles an entry made only of `@import`s as one compile per import, in
+ * parallel on the compile pool, and joins their output in source order.
+ * The leading imports that output no CSS (settings, functions, mixins)
+ * become a prelude every other import is compiled after; those others
+ * must not depend on anything one another defines, and `@extend` does not
+ * reach across them. Entries this can't be done for, and compiles with
+ * source maps, are compiled as a whole.
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+module.exports = function(options) {
+  var whole = assign({}, options, { parallelImports: false });
+
+  if (!canSplit(options)) {
+    return sass.render(whole);
+  }
+
+  var success = options.success || function() {};
+  var error = options.error || function() {};
+  var stats = options.stats || {};
+  var compressed = (options.output_style || options.outputStyle) === 'compressed';
+  var included = {};
+  var cancelled = false;
+  var delegated = false;
+  var handle = null;
+  var imports;
+
+  var base = assign({}, options, {
+    includePaths: [path.dirname(path.resolve(options.file))].concat(options.include_paths || options.includePaths || [])
+  });
+
+  ['error', 'file', 'include_paths', 'parallelImports', 'stats', 'success', 'writeToDisk'].forEach(function(name) {
+    delete base[name];
+  });
+
+  stats.entry = options.file;
+  stats.start = Date.now();
+
+  function include(includedFiles) {
+    (includedFiles || []).forEach(function(file) {
+      included[file] = true;
+    });
+  }
+
+  function fail(err, status, details) {
+    if (!cancelled) {
+      cancelled = true;
+      error(err, status, details);
+    }
+  }
+
+  function finish(outputs) {
+    var css = outputs.map(function(output) {
+      return String(output).replace(/\s+$/, '');
+    }).join(compressed ? '' : '\n') + '\n';
+
+    included[path.resolve(options.file).replace(/\\/g, '/')] = true;
+    stats.includedFiles = Object.keys(included).sort();
+    stats.end = Date.now();
+    stats.duration = stats.end - stats.start;
+
+    if (!options.writeToDisk) {
+      return success(options.outputBuffer ? new Buffer(css) : css, null);
+    }
+
+    fs.writeFile(options.writeToDisk.css, css, function(err) {
+      return err ? error(err.message, err.code || 'EIO') : success(null, null);
+    });
+  }
+
+  // the first import with output is compiled on its own; the rest are
+  // batched after the prelude before it
+  function fanOut(n, first) {
+    var prelude = sass.createPrelude({ data: imports.slice(0, n).map(importStatement).join('') });
+
+    handle = sass.renderBatch(imports.slice(n + 1).map(function(url) {
+      return assign({}, base, { prelude: prelude, data: importStatement(url), stats: {} });
+    }), function(err, results) {
+      if (cancelled) {
+        return;
+      }
+
+      var failed = results.filter(function(result) {
+        return result.error;
+      })[0];
+
+      if (failed) {
+        return fail(failed.error, failed.status, failed.details);
+      }
+
+      results.forEach(function(result) {
+        include(result.stats.includedFiles);
+      });
+
+      finish([first].concat(results.map(function(result) {
+        return result.css;
+      })));
+    });
+  }
+
+  // compiles the first `n` imports, which output no CSS while they are
+  // all prelude
+  function probe(n, cb) {
+    var probeStats = {};
+
+    handle = sass.render(assign({}, base, {
+      data: imports.slice(0, n).map(importStatement).join(''),
+      stats: probeStats,
+      success: function(css) {
+        if (cancelled) {
+          return;
+        }
+
+        include(probeStats.includedFiles);
+        cb(String(css).trim() ? css : null);
+      },
+      error: fail
+    }));
+  }
+
+  // finds the shortest prefix with output by doubling it and then
+  // bisecting, so the prelude takes O(log n) compiles rather than one per
+  // import; `lo` imports are known to output nothing and `hi` to output `css`
+  function bisect(lo, hi, css) {
+    if (hi - lo === 1) {
+      return fanOut(lo, css);
+    }
+
+    var mid = Math.floor((lo + hi) / 2);
+
+    probe(mid, function(output) {
+      return output ? bisect(lo, mid, output) : bisect(mid, hi, css);
+    });
+  }
+
+  function gallop(lo, n) {
+    probe(n, function(css) {
+      if (css) {
+        return bisect(lo, n, css);
+      }
+
+      if (n === imports.length) {
+        return finish(['']);
+      }
+
+      gallop(n, Math.min(n * 2, imports.length));
+    });
+  }
+
+  fs.readFile(options.file, 'utf8', function(err, source) {
+    if (cancelled) {
+      return;
+    }
+
+    imports = !err && getImports(source);
+
+    if (!imports) {
+      delegated = true;
+      handle = sass.render(whole);
+      return;
+    }
+
+    gallop(0, 1);
+  });
+
+  return {
+    cancel: function() {
+      if (delegated) {
+        return handle.cancel();
+      }
+
+      if (cancelled) {
+        return false;
+      }
+
+      if (handle) {
+        handle.cancel();
+      }
+
+      fail('Compile cancelled', 'ECANCELED');
+      return true;
+    }
+  };
+};
@@ -1,26 +1,32 @@
-var fs = require('fs'),
-    chalk = require('chalk'),
+var chalk = require('chalk'),
+    fs = require('fs'),
     sass = require('./');
 
 /**
  * Render
  *
+ * Returns a handle whose `cancel()` drops the render.
+ *
  * @param {Object} options
  * @param {Object} emitter
  * @api public
  */
 
 module.exports = function(options, emitter) {
+  var stdout = options.stdout || (!options.dest && !process.stdout.isTTY);
   var renderOptions = {
+    cacheDir: options.cacheDir,
     imagePath: options.imagePath,
     includePaths: options.includePath,
     omitSourceMapUrl: options.omitSourceMapUrl,
     indentedSyntax: options.indentedSyntax,
     outFile: options.dest,
     outputStyle: options.outputStyle,
+    parallelImports: options.parallelImports,
     precision: options.precision,
     sourceComments: options.sourceComments,
-    sourceMap: options.sourceMap
+    sourceMap: options.sourceMap,
+    stats: {}
   };
 
   if (options.src) {
@@ -29,51 +35,58 @@ module.exports = function(options, emitter) {
     renderOptions.data = options.data;
   }
 
-  renderOptions.success = function(css, sourceMap) {
-    var todo = 1;
-    var done = function() {
-      if (--todo <= 0) {
-        emitter.emit('done');
-      }
+  // the binding writes the CSS and source map from its worker thread
+  if (!stdout) {
+    renderOptions.writeToDisk = {
+      css: options.dest,
+      sourceMap: options.sourceMap || null
     };
+  }
 
-    if (options.stdout || (!options.dest && !process.stdout.isTTY)) {
-      emitter.emit('log', css);
-      return done();
+  renderOptions.success = function(css, sourceMap) {
+    emitter.emit('render', css, renderOptions.stats);
+
+    if (stdout) {
+      emitter.emit('log', String(css));
+      return emitter.emit('done');
     }
 
-    emitter.emit('warn', chalk.green('Rendering Complete, saving .css file...'));
+    // a cache hit hands back the output instead of writing it
+    if (css !== null) {
+      fs.writeFileSync(options.dest, css);
 
-    fs.writeFile(options.dest, css, function(err) {
-      if (err) {
-        return emitter.emit('error', chalk.red('Error: ' + err));
+      if (options.sourceMap && sourceMap) {
+        fs.writeFileSync(options.sourceMap, sourceMap);
       }
+    }
 
-      emitter.emit('warn', chalk.green('Wrote CSS to ' + options.dest));
-      emitter.emit('write', err, options.dest, css);
-      done();
-    });
+    emitter.emit('warn', chalk.green('Wrote CSS to ' + options.dest));
+    emitter.emit('write', null, options.dest);
 
     if (options.sourceMap) {
-      todo++;
-
-      fs.writeFile(options.sourceMap, sourceMap, function(err) {
-        if (err) {
-          return emitter.emit('error', chalk.red('Error' + err));
-        }
-
-        emitter.emit('warn', chalk.green('Wrote Source Map to ' + options.sourceMap));
-        emitter.emit('write-source-map', err, options.sourceMap, sourceMap);
-        done();
-      });
+      emitter.emit('warn', chalk.green('Wrote Source Map to ' + options.sourceMap));
+      emitter.emit('write-source-map', null, options.sourceMap);
     }
 
-    emitter.emit('render', css);
+    emitter.emit('done');
   };
 
-  renderOptions.error = function(error) {
+  renderOptions.error = function(error, status) {
+    // superseded by a newer render of the same entry
+    if (status === 'ECANCELED') {
+      return;
+    }
+
     emitter.emit('error', chalk.red(error));
   };
 
-  sass.render(renderOptions);
+  // stdin is streamed into the compile rather than read up front
+  if (renderOptions.data && typeof renderOptions.data.pipe === 'function') {
+    var input = renderOptions.data;
+
+    delete renderOptions.data;
+    return input.pipe(sass.renderStream(renderOptions));
+  }
+
+  return sass.render(renderOptions);
 };
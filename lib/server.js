@@ -0,0 +1,293 @@
+var path = require('path'),
+    readline = require('readline'),
+    assign = require('object-assign'),
+    sass = require('./'),
+    Graph = require('./graph');
+
+/**
+ * JSON-RPC error codes
+ *
+ * Compile failures use the implementation-defined server error range; the
+ * libsass status is in the error's `data`.
+ */
+
+var PARSE_ERROR = -32700;
+var INVALID_REQUEST = -32600;
+var METHOD_NOT_FOUND = -32601;
+var INTERNAL_ERROR = -32603;
+var COMPILE_ERROR = -32000;
+
+/**
+ * Entries remembered for `changed`; the least recently rendered goes first
+ */
+
+var MAX_ENTRIES = 1000;
+
+/**
+ * Server
+ *
+ * Answers compile requests for a long-lived process, such as an editor or
+ * a dev server, so the binding is loaded once and the output cache and the
+ * dependency graph stay warm between requests.
+ *
+ * Requests and responses are JSON-RPC 2.0 objects, one per line:
+ *
+ *   {"jsonrpc":"2.0","id":1,"method":"render","params":{"file":"a.scss"}}
+ *   {"jsonrpc":"2.0","id":1,"result":{"css":"...","sourceMap":null,"stats":{}}}
+ *
+ * @param {Object} defaults
+ * @api public
+ */
+
+function Server(defaults) {
+  this.defaults = defaults || {};
+  this.cache = new sass.Cache();
+  this.graph = new Graph();
+  this.entries = {};
+  this.size = 0;
+}
+
+/**
+ * Render
+ *
+ * Compiles `params`, which accepts the options of `render()` besides the
+ * callbacks, and records the entry in the graph.
+ *
+ * @param {Object} params
+ * @param {Function} cb
+ * @api private
+ */
+
+Server.prototype.render = function(params, cb) {
+  var graph = this.graph;
+  var options = assign({}, this.defaults, params, {
+    cache: this.cache,
+    outputBuffer: false,
+    stats: {},
+    success: function(css, sourceMap) {
+      if (options.file) {
+        graph.add(options.file, options.stats.includedFiles);
+      }
+
+      cb(null, { css: css, sourceMap: sourceMap, stats: options.stats });
+    },
+    error: function(err, status, details) {
+      cb({
+        code: COMPILE_ERROR,
+        message: String(err instanceof Error ? err.message : err),
+        data: assign({}, details, { status: status })
+      });
+    }
+  });
+
+  if (params.file) {
+    this.remember(params);
+  }
+
+  sass.render(options);
+};
+
+/**
+ * Remember
+ *
+ * Keeps the options an entry was last rendered with, under the same key
+ * as the graph's entries. Beyond `MAX_ENTRIES`, the least recently
+ * rendered entry is dropped from both.
+ *
+ * @param {Object} params
+ * @api private
+ */
+
+Server.prototype.remember = function(params) {
+  var entry = path.resolve(params.file).replace(/\\/g, '/');
+
+  if (this.entries[entry]) {
+    delete this.entries[entry];
+  } else {
+    this.size++;
+  }
+
+  this.entries[entry] = params;
+
+  for (var oldest in this.entries) {
+    if (this.size <= MAX_ENTRIES) {
+      break;
+    }
+
+    delete this.entries[oldest];
+    this.graph.remove(oldest);
+    this.size--;
+  }
+};
+
+/**
+ * Changed
+ *
+ * Recompiles every entry that includes `params.file`, with the options it
+ * was last rendered with.
+ *
+ * @param {Object} params
+ * @param {Function} cb
+ * @api private
+ */
+
+Server.prototype.changed = function(params, cb) {
+  var self = this;
+  var entries = this.graph.getEntries(params.file);
+  var results = [];
+  var pending = entries.length;
+
+  if (!pending) {
+    return cb(null, results);
+  }
+
+  entries.forEach(function(entry, i) {
+    var options = self.entries[entry] || { file: entry };
+
+    self.render(options, function(err, result) {
+      results[i] = assign({ entry: entry }, err ? { error: err } : result);
+
+      if (--pending === 0) {
+        cb(null, results);
+      }
+    });
+  });
+};
+
+/**
+ * Handle
+ *
+ * Calls `cb` with the response, or with nothing for a notification, a
+ * request without an `id`.
+ *
+ * @param {Object} request
+ * @param {Function} cb
+ * @api public
+ */
+
+Server.prototype.handle = function(request, cb) {
+  var valid = request !== null && typeof request === 'object' && !Array.isArray(request) &&
+    request.jsonrpc === '2.0' && typeof request.method === 'string';
+  var notification = valid && !request.hasOwnProperty('id');
+  var method = valid && methods.hasOwnProperty(request.method) ? methods[request.method] : null;
+
+  function respond(err, result) {
+    var response = { jsonrpc: '2.0', id: valid && request.id !== undefined ? request.id : null };
+
+    if (notification) {
+      return cb();
+    }
+
+    if (err) {
+      response.error = err;
+    } else {
+      response.result = result;
+    }
+
+    cb(response);
+  }
+
+  if (!valid) {
+    return respond({ code: INVALID_REQUEST, message: 'Invalid Request' });
+  }
+
+  if (!method) {
+    return respond({ code: METHOD_NOT_FOUND, message: 'Method not found: ' + request.method });
+  }
+
+  try {
+    method.call(this, request.params || {}, respond);
+  } catch (err) {
+    respond({ code: INTERNAL_ERROR, message: err.message });
+  }
+};
+
+/**
+ * Handle batch
+ *
+ * Answers an array of requests with an array of the responses that are
+ * not to notifications, or with nothing if all of them were.
+ *
+ * @param {Array} batch
+ * @param {Function} cb
+ * @api public
+ */
+
+Server.prototype.handleBatch = function(batch, cb) {
+  var responses = [];
+  var pending = batch.length;
+
+  if (!pending) {
+    return cb({ jsonrpc: '2.0', id: null, error: { code: INVALID_REQUEST, message: 'Invalid Request' } });
+  }
+
+  batch.forEach(function(request, i) {
+    this.handle(request, function(response) {
+      responses[i] = response;
+
+      if (--pending === 0) {
+        responses = responses.filter(Boolean);
+        cb(responses.length ? responses : undefined);
+      }
+    });
+  }, this);
+};
+
+/**
+ * Listen
+ *
+ * Reads requests from `input` and writes responses to `output`, which may
+ * be the same duplex stream, e.g. a socket.
+ *
+ * @param {Object} input
+ * @param {Object} output
+ * @api public
+ */
+
+Server.prototype.listen = function(input, output) {
+  var self = this;
+  var lines = readline.createInterface({ input: input, terminal: false });
+
+  function send(response) {
+    if (response) {
+      output.write(JSON.stringify(response) + '\n');
+    }
+  }
+
+  lines.on('line', function(line) {
+    var request;
+
+    if (!line.trim()) {
+      return;
+    }
+
+    try {
+      request = JSON.parse(line);
+    } catch (err) {
+      return send({ jsonrpc: '2.0', id: null, error: { code: PARSE_ERROR, message: 'Parse error' } });
+    }
+
+    if (Array.isArray(request)) {
+      return self.handleBatch(request, send);
+    }
+
+    self.handle(request, send);
+  });
+
+  return lines;
+};
+
+/**
+ * Methods
+ */
+
+var methods = {
+  render: Server.prototype.render,
+  changed: Server.prototype.changed
+};
+
+/**
+ * Module exports
+ */
+
+module.exports = Server;
@@ -0,0 +1,141 @@
+var EventEmitter = require('events').EventEmitter,
+    fs = require('fs'),
+    util = require('util');
+
+/**
+ * Tracer
+ *
+ * Turns the stage timestamps the binding records while tracing into
+ * Chrome trace events: marshalling and result conversion on the loop
+ * thread, the compile and writing output on the compile thread that ran
+ * it, and the whole compile, including its time in the queue, as an async
+ * span. Every event is emitted as `event` and kept for `write()`.
+ *
+ * @api public
+ */
+
+function Tracer() {
+  EventEmitter.call(this);
+
+  this.events = [];
+  this.threads = {};
+  this.id = 0;
+}
+
+util.inherits(Tracer, EventEmitter);
+
+/**
+ * Push
+ *
+ * @param {Object} event
+ * @api private
+ */
+
+Tracer.prototype.push = function(event) {
+  event.cat = 'sass';
+  event.pid = process.pid;
+
+  this.events.push(event);
+  this.emit('event', event);
+};
+
+/**
+ * Name thread
+ *
+ * @param {Number} tid
+ * @api private
+ */
+
+Tracer.prototype.nameThread = function(tid) {
+  if (this.threads[tid]) {
+    return;
+  }
+
+  this.threads[tid] = true;
+  this.push({
+    name: 'thread_name',
+    ph: 'M',
+    tid: tid,
+    args: { name: tid ? 'node-sass compile thread ' + tid : 'node-sass loop thread' }
+  });
+};
+
+/**
+ * Span
+ *
+ * @param {String} name
+ * @param {Number} tid
+ * @param {Number} start
+ * @param {Number} end
+ * @param {Object} args
+ * @api private
+ */
+
+Tracer.prototype.span = function(name, tid, start, end, args) {
+  this.nameThread(tid);
+  this.push({ name: name, ph: 'X', tid: tid, ts: start, dur: end - start, args: args });
+};
+
+/**
+ * Add
+ *
+ * Adds the events of one compile from its `stats`.
+ *
+ * @param {Object} stats
+ * @api public
+ */
+
+Tracer.prototype.add = function(stats) {
+  var trace = stats.trace;
+
+  if (!trace) {
+    return;
+  }
+
+  var thread = trace[0];
+  var args = { entry: stats.entry };
+  var id = ++this.id;
+
+  this.push({ name: stats.entry, ph: 'b', id: id, tid: 0, ts: trace[1], args: args });
+  this.push({ name: 'queue', ph: 'b', id: id, tid: 0, ts: trace[2], args: args });
+  this.push({ name: 'queue', ph: 'e', id: id, tid: 0, ts: trace[3] });
+
+  this.span('marshal', 0, trace[1], trace[2], args);
+  this.span('compile', thread, trace[3], trace[4], args);
+
+  if (trace[5]) {
+    this.span('write', thread, trace[4], trace[5], args);
+  }
+
+  this.span('callback', 0, trace[6], trace[7], args);
+  this.push({ name: stats.entry, ph: 'e', id: id, tid: 0, ts: trace[7] });
+};
+
+/**
+ * To JSON
+ *
+ * @api public
+ */
+
+Tracer.prototype.toJSON = function() {
+  return { traceEvents: this.events };
+};
+
+/**
+ * Write
+ *
+ * Saves the events as a trace file for `chrome://tracing`.
+ *
+ * @param {String} file
+ * @api public
+ */
+
+Tracer.prototype.write = function(file) {
+  fs.writeFileSync(file, JSON.stringify(this));
+};
+
+/**
+ * Module exports
+ */
+
+module.exports = Tracer;
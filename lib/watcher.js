@@ -0,0 +1,131 @@
+var EventEmitter = require('events').EventEmitter,
+    path = require('path'),
+    util = require('util'),
+    sass = require('./');
+
+/**
+ * Watcher
+ *
+ * Watches directories with the binding's native backend, on inotify,
+ * FSEvents or ReadDirectoryChangesW, rather than by polling. A burst of
+ * events is reported as a single `change` event with every path that was
+ * touched, once no further event arrived for `options.delay` milliseconds.
+ *
+ * @param {Object} options
+ * @api public
+ */
+
+function Watcher(options) {
+  EventEmitter.call(this);
+
+  options = options || {};
+
+  this.delay = options.delay === undefined ? 25 : options.delay;
+  this.dirs = {};
+  this.pending = {};
+  this.timer = null;
+  this.handle = new sass.FileWatcher(this.onEvent.bind(this));
+}
+
+util.inherits(Watcher, EventEmitter);
+
+/**
+ * Update
+ *
+ * Watches exactly `dirs`, starting and stopping native watches only for
+ * directories that were added or dropped since the last update.
+ *
+ * @param {Array} dirs
+ * @api public
+ */
+
+Watcher.prototype.update = function(dirs) {
+  var wanted = {};
+
+  dirs.forEach(function(dir) {
+    wanted[path.resolve(dir)] = true;
+  });
+
+  Object.keys(this.dirs).forEach(function(dir) {
+    if (!wanted[dir]) {
+      this.handle.unwatch(dir);
+      delete this.dirs[dir];
+    }
+  }, this);
+
+  // a directory that can't be watched is reported once, and only tried
+  // again after it has left the set
+  Object.keys(wanted).forEach(function(dir) {
+    if (dir in this.dirs) {
+      return;
+    }
+
+    this.dirs[dir] = this.handle.watch(dir) === 0;
+
+    if (!this.dirs[dir]) {
+      this.emit('error', 'Could not watch `' + dir + '`');
+    }
+  }, this);
+};
+
+/**
+ * Get watched directories
+ *
+ * @api public
+ */
+
+Watcher.prototype.watched = function() {
+  return Object.keys(this.dirs).filter(function(dir) {
+    return this.dirs[dir];
+  }, this);
+};
+
+/**
+ * On event
+ *
+ * @param {String} dir
+ * @param {String} filename
+ * @param {Number} status
+ * @api private
+ */
+
+Watcher.prototype.onEvent = function(dir, filename, status) {
+  // some backends can't tell which entry of the directory changed
+  this.pending[filename && !status ? path.join(dir, filename) : dir] = true;
+
+  clearTimeout(this.timer);
+  this.timer = setTimeout(this.flush.bind(this), this.delay);
+};
+
+/**
+ * Flush
+ *
+ * @api private
+ */
+
+Watcher.prototype.flush = function() {
+  var files = Object.keys(this.pending);
+
+  this.pending = {};
+  this.timer = null;
+  this.emit('change', files);
+};
+
+/**
+ * Close
+ *
+ * @api public
+ */
+
+Watcher.prototype.close = function() {
+  clearTimeout(this.timer);
+  this.handle.close();
+  this.dirs = {};
+  this.pending = {};
+};
+
+/**
+ * Module exports
+ */
+
+module.exports = Watcher;
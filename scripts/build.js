@@ -1,4 +1,5 @@
 var fs = require('fs'),
+    os = require('os'),
     path = require('path'),
     spawn = require('child_process').spawn,
     mkdir = require('mkdirp'),
@@ -8,10 +9,11 @@ var fs = require('fs'),
  * After build
  *
  * @param {Object} options
+ * @param {Function} cb
  * @api private
  */
 
-function afterBuild(options) {
+function afterBuild(options, cb) {
   var folder = options.debug ? 'Debug' : 'Release';
   var target = path.join(__dirname, '..', 'build', folder, 'binding.node');
   var install = path.join(__dirname, '..', 'vendor', options.bin, 'binding.node');
@@ -35,6 +37,10 @@ function afterBuild(options) {
         }
 
         console.log('Installed in `' + install + '`');
+
+        if (cb) {
+          cb();
+        }
       });
     });
   });
@@ -47,9 +53,15 @@ function afterBuild(options) {
  * @api private
  */
 
-function build(options) {
+function build(options, pgo, cb) {
   var bin = options.platform === 'win32' ? 'node-gyp.cmd' : 'node-gyp';
-  var proc = spawn(bin, ['rebuild'].concat(options.args), {
+  var args = ['rebuild'].concat(options.args, getVariables(options, pgo));
+
+  if (options.pgo && pgo === undefined) {
+    return buildWithProfile(options);
+  }
+
+  var proc = spawn(bin, args, {
     customFds: [0, 1, 2]
   });
 
@@ -68,7 +80,96 @@ function build(options) {
       return;
     }
 
-    afterBuild(options);
+    afterBuild(options, cb);
+  });
+}
+
+/**
+ * Get gyp variables for an optimized build
+ *
+ * @param {Object} options
+ * @param {String} pgo
+ * @api private
+ */
+
+function getVariables(options, pgo) {
+  var variables = [];
+
+  if (options.lto) {
+    variables.push('--sass_lto=true');
+  }
+
+  if (options.native) {
+    variables.push('--sass_native=true');
+  }
+
+  if (pgo) {
+    variables.push('--sass_pgo=' + pgo, '--sass_pgo_dir=' + options.profileDir);
+  }
+
+  return variables;
+}
+
+/**
+ * Remove a directory and everything in it
+ *
+ * @param {String} dir
+ * @api private
+ */
+
+function removeDir(dir) {
+  if (!fs.existsSync(dir)) {
+    return;
+  }
+
+  fs.readdirSync(dir).forEach(function(name) {
+    var file = path.join(dir, name);
+
+    if (fs.statSync(file).isDirectory()) {
+      removeDir(file);
+    } else {
+      fs.unlinkSync(file);
+    }
+  });
+
+  fs.rmdirSync(dir);
+}
+
+/**
+ * Build with profile-guided optimization
+ *
+ * Builds an instrumented binary, trains it on the benchmark corpus and
+ * rebuilds using the recorded profile. The profile directory is emptied
+ * first, since gcc merges new counts into any profile already there. If
+ * training fails, the instrumented binary is replaced by a build without
+ * a profile.
+ *
+ * @param {Object} options
+ * @api private
+ */
+
+function buildWithProfile(options) {
+  options.profileDir = path.join(os.tmpdir(), 'node-sass-pgo-' + options.bin);
+  removeDir(options.profileDir);
+
+  build(options, 'generate', function() {
+    console.log('Training on the benchmark corpus');
+
+    var proc = spawn(process.execPath, [
+      path.join(__dirname, '..', 'bench'),
+      'renderSync', 'render'
+    ], {
+      customFds: [0, 1, 2]
+    });
+
+    proc.on('exit', function(code) {
+      if (code) {
+        console.error('Training failed; building without a profile');
+        return build(options, false);
+      }
+
+      build(options, 'use');
+    });
   });
 }
 
@@ -94,11 +195,21 @@ function parseArgs(args) {
       options.arch = arg.substring(14);
     } else if (arg === '--debug') {
       options.debug = true;
+    } else if (arg === '--lto' || arg === '--pgo' || arg === '--native') {
+      // optimized builds are always built from source
+      options[arg.substring(2)] = options.force = true;
+      return false;
     }
 
     return true;
   });
 
+  // binding.gyp only has profile-guided builds for gcc
+  if (options.pgo && (options.platform === 'win32' || options.platform === 'darwin')) {
+    console.warn('--pgo is not supported on ' + options.platform + '; building without a profile');
+    options.pgo = false;
+  }
+
   return options;
 }
 
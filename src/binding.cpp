@@ -1,221 +1,863 @@
 #include <nan.h>
+#include <algorithm>
+#include <map>
+#include <set>
 #include <string>
+#include <cctype>
 #include <cstring>
 #include <iostream>
 #include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
 #include "sass_context_wrapper.h"
+#include "compile_pool.h"
+#include "compiled_options.h"
+#include "memory_budget.h"
+#include "prelude.h"
+#include "source_buffer.h"
+#include "watcher.h"
 
 using namespace v8;
 using namespace std;
 
+// queued and running async contexts by id, so JS can cancel them
+map<uint32_t, sass_context_wrapper*> inflight;
+uint32_t next_id = 0;
+
+// guards `cancelled` of running contexts, which compile threads check
+// before they move their output into place
+uv_mutex_t cancel_mutex;
+
+// Copies a message into memory the wrapper frees with the context.
+char* CopyError(const string& message) {
+  char* error = (char*) malloc(message.length() + 1);
+  strcpy(error, message.c_str());
+  return error;
+}
+
+// libsass keeps nothing of a compile that could be serialized again, so
+// every further style is compiled from a copy of the context's options.
+// They still share one job: one trip through the pool, one marshalling of
+// the options and one callback. A failure is reported like a failed write.
+void CompileStyles(sass_context_wrapper* ctx_w) {
+  for (int i = 1; i < ctx_w->num_styles && !ctx_w->write_error; i++) {
+    if (ctx_w->ctx) {
+      sass_context* ctx = sass_new_context();
+      ctx->source_string = ctx_w->ctx->source_string;
+      ctx->output_path = ctx_w->ctx->output_path;
+      ctx->options = ctx_w->ctx->options;
+      ctx->options.output_style = ctx_w->styles[i];
+      sass_compile(ctx);
+
+      if (ctx->error_status) {
+        ctx_w->write_error = CopyError(ctx->error_message);
+      } else {
+        ctx_w->outputs[i] = ctx->output_string;
+        ctx->output_string = NULL;
+      }
+      sass_free_context(ctx);
+    } else {
+      sass_file_context* ctx = sass_new_file_context();
+      ctx->input_path = ctx_w->fctx->input_path;
+      ctx->output_path = ctx_w->fctx->output_path;
+      ctx->options = ctx_w->fctx->options;
+      ctx->options.output_style = ctx_w->styles[i];
+      sass_compile_file(ctx);
+
+      if (ctx->error_status) {
+        ctx_w->write_error = CopyError(ctx->error_message);
+      } else {
+        ctx_w->outputs[i] = ctx->output_string;
+        ctx_w->source_maps[i] = ctx->source_map_string;
+        ctx->output_string = NULL;
+        ctx->source_map_string = NULL;
+      }
+      sass_free_file_context(ctx);
+    }
+  }
+}
+
+// strerror is not thread-safe; glibc's strerror_r returns the message, the
+// POSIX one a status and fills in the buffer
+const char* ErrorText(int status, char* buffer) {
+  return status == 0 ? buffer : "Unknown error";
+}
+
+const char* ErrorText(char* message, char*) {
+  return message;
+}
+
+string ErrorString(int err) {
+  char buffer[256];
+#ifdef _WIN32
+  strerror_s(buffer, sizeof(buffer), err);
+  return buffer;
+#else
+  return ErrorText(strerror_r(err, buffer, sizeof(buffer)), buffer);
+#endif
+}
+
+// Returns 0 or the error of moving `from` over `to`.
+int MoveOver(const char* from, const char* to) {
+#ifdef _WIN32
+  // rename() does not replace an existing file on Windows
+  return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) ? 0 : EACCES;
+#else
+  return rename(from, to) == 0 ? 0 : errno;
+#endif
+}
+
+// The error of the last call, which may not have set errno at all.
+int LastError() {
+  return errno ? errno : EIO;
+}
+
+// Writes through a temporary file next to `path`, like the disk cache
+// does, so a reader never sees a partial file and a failed write leaves
+// the previous one in place. A compile cancelled in the meantime, e.g. one
+// superseded by a newer compile of the same file, leaves it in place too.
+char* WriteFile(const char* path, const char* data, sass_context_wrapper* ctx_w) {
+  char suffix[64];
+  sprintf(suffix, ".%d.%p.tmp", (int) getpid(), (const void*) data);
+
+  string tmp = string(path) + suffix;
+  size_t length = strlen(data);
+  int err = 0;
+
+  errno = 0;
+  FILE* file = fopen(tmp.c_str(), "wb");
+
+  if (!file) {
+    err = LastError();
+  } else {
+    errno = 0;
+    if (fwrite(data, 1, length, file) != length) {
+      err = LastError();
+    }
+
+    errno = 0;
+    if (fclose(file) != 0 && !err) {
+      err = LastError();
+    }
+  }
+
+  if (!err) {
+    // held across the rename, so a cancel can't slip in between
+    uv_mutex_lock(&cancel_mutex);
+    bool cancelled = ctx_w->cancelled;
+
+    if (!cancelled) {
+      err = MoveOver(tmp.c_str(), path);
+    }
+    uv_mutex_unlock(&cancel_mutex);
+
+    if (cancelled) {
+      remove(tmp.c_str());
+      return NULL;
+    }
+  }
+
+  if (!err) {
+    return NULL;
+  }
+
+  remove(tmp.c_str());
+  return CopyError(string("Could not write `") + path + "`: " + ErrorString(err));
+}
+
 void WorkOnContext(uv_work_t* req) {
   sass_context_wrapper* ctx_w = static_cast<sass_context_wrapper*>(req->data);
+  char* output = NULL;
+  char* source_map = NULL;
+
+  ctx_w->compile_start = uv_hrtime();
+  sass_memory_budget_enter(&ctx_w->memory);
+
+  if (ctx_w->trace) {
+    ctx_w->thread = compile_pool_thread(req) + 1;
+  }
+
   if (ctx_w->ctx) {
     sass_context* ctx = static_cast<sass_context*>(ctx_w->ctx);
     sass_compile(ctx);
+    output = ctx->error_status ? NULL : ctx->output_string;
   } else if (ctx_w->fctx) {
     sass_file_context* ctx = static_cast<sass_file_context*>(ctx_w->fctx);
     sass_compile_file(ctx);
+    output = ctx->error_status ? NULL : ctx->output_string;
+    source_map = ctx->error_status ? NULL : ctx->source_map_string;
+  }
+
+  if (output) {
+    CompileStyles(ctx_w);
+  }
+
+  sass_memory_budget_enter(NULL);
+  ctx_w->compile_end = uv_hrtime();
+
+  // write straight from the worker so the output never enters JS
+  if (ctx_w->css_path && output) {
+    ctx_w->write_error = WriteFile(ctx_w->css_path, output, ctx_w);
+
+    if (!ctx_w->write_error && ctx_w->source_map_path && source_map) {
+      ctx_w->write_error = WriteFile(ctx_w->source_map_path, source_map, ctx_w);
+    }
+
+    ctx_w->write_end = uv_hrtime();
   }
 }
 
-char* CreateString(Local<Value> value) {
-  if(value->IsNull() || !value->IsString()) {
-    return const_cast<char*>(""); // return empty string.
+// Copies a JS string into the compile's arena; anything else becomes "".
+char* CreateString(sass_context_wrapper* ctx_w, Local<Value> value) {
+  if (!value->IsString()) {
+    return sass_arena_copy(&ctx_w->arena, "", 0);
   }
 
   String::Utf8Value string(value);
-  char *str = (char *) malloc(string.length() + 1);
-  strcpy(str, *string);
-  return str;
+  return sass_arena_copy(&ctx_w->arena, *string, string.length());
+}
+
+void FreeOutputString(char* data, void* hint) {
+  free(data);
+}
+
+// Hands the libsass-allocated output to JS, either as a copied string or as
+// an external Buffer that takes ownership of it.
+Local<Value> OutputValue(char** output, bool asBuffer) {
+  if (!asBuffer) {
+    return NanNew<String>(*output);
+  }
+
+  char* data = *output;
+  *output = NULL;
+  return NanNewBufferHandle(data, strlen(data), FreeOutputString, NULL);
 }
 
-void ExtractOptions(Local<Value> optionsValue, void* cptr, sass_context_wrapper* ctx_w, bool isFile) {
+// Fills in the context from the options object. Its strings are copied into
+// the wrapper's arena, or lent by a CompiledOptions object, which async
+// compiles keep alive until they are done.
+void ExtractOptions(Local<Value> optionsValue, void* cptr, sass_context_wrapper* ctx_w, bool isFile, bool isAsync) {
   bool source_comments;
   Local<Object> options = optionsValue->ToObject();
+  Local<Value> compiled = options->Get(OPTION_KEY(compiled));
 
-  if (ctx_w) {
-    NanAssignPersistent(ctx_w->stats, options->Get(NanNew("stats"))->ToObject());
+  if (isFile) {
+    ctx_w->fctx = (sass_file_context*) cptr;
+  } else {
+    ctx_w->ctx = (sass_context*) cptr;
+  }
+  ctx_w->collect_stats = options->Get(OPTION_KEY(collectStats))->BooleanValue();
+  ctx_w->trace = options->Get(OPTION_KEY(trace))->BooleanValue();
 
-    // async (callback) style
-    Local<Function> callback = Local<Function>::Cast(options->Get(NanNew("success")));
-    Local<Function> errorCallback = Local<Function>::Cast(options->Get(NanNew("error")));
-    if (isFile) {
-      ctx_w->fctx = (sass_file_context*) cptr;
-    } else {
-      ctx_w->ctx = (sass_context*) cptr;
+  Local<Value> maxMemory = options->Get(OPTION_KEY(maxMemory));
+  ctx_w->memory.limit = maxMemory->IsNumber() && maxMemory->NumberValue() > 0 ? (size_t) maxMemory->NumberValue() : 0;
+
+  Local<Value> styles = options->Get(OPTION_KEY(styles));
+  if (styles->IsArray()) {
+    Local<Array> list = Local<Array>::Cast(styles);
+    ctx_w->num_styles = min((int) list->Length(), SASS_STYLE_COUNT);
+
+    for (int i = 0; i < ctx_w->num_styles; i++) {
+      ctx_w->styles[i] = list->Get(i)->Int32Value();
     }
+  }
+
+  if (isAsync) {
+    NanAssignPersistent(ctx_w->stats, options->Get(OPTION_KEY(stats))->ToObject());
+
+    // async (callback) style
+    Local<Function> callback = Local<Function>::Cast(options->Get(OPTION_KEY(success)));
+    Local<Function> errorCallback = Local<Function>::Cast(options->Get(OPTION_KEY(error)));
     ctx_w->request.data = ctx_w;
+    ctx_w->output_buffer = options->Get(OPTION_KEY(outputBuffer))->BooleanValue();
+
+    Local<Value> writeToDisk = options->Get(OPTION_KEY(writeToDisk));
+    if (writeToDisk->IsObject()) {
+      Local<Value> css = writeToDisk->ToObject()->Get(OPTION_KEY(css));
+      Local<Value> sourceMap = writeToDisk->ToObject()->Get(OPTION_KEY(sourceMap));
+      ctx_w->css_path = css->IsString() ? CreateString(ctx_w, css) : NULL;
+      ctx_w->source_map_path = sourceMap->IsString() ? CreateString(ctx_w, sourceMap) : NULL;
+    }
     ctx_w->callback = new NanCallback(callback);
     ctx_w->errorCallback = new NanCallback(errorCallback);
+
+    if (CompiledOptions::HasInstance(compiled)) {
+      // keeps the lent strings alive until the compile is done
+      NanAssignPersistent(ctx_w->compiled, compiled->ToObject());
+    }
   }
 
-  if (isFile) {
+  if (CompiledOptions::HasInstance(compiled)) {
+    CompiledOptions* co = node::ObjectWrap::Unwrap<CompiledOptions>(compiled->ToObject());
+
+    if (isFile) {
+      co->Apply((sass_file_context*) cptr);
+    } else {
+      co->Apply((sass_context*) cptr);
+    }
+  } else if (isFile) {
     sass_file_context* ctx = (sass_file_context*) cptr;
-    ctx->input_path = CreateString(options->Get(NanNew("file")));
-    ctx->output_path = CreateString(options->Get(NanNew("outFile")));
-    ctx->options.image_path = CreateString(options->Get(NanNew("imagePath")));
-    ctx->options.output_style = options->Get(NanNew("style"))->Int32Value();
-    ctx->options.source_comments = source_comments = options->Get(NanNew("comments"))->BooleanValue();
-    ctx->options.omit_source_map_url = options->Get(NanNew("omitSourceMapUrl"))->BooleanValue();
-    ctx->options.source_map_file = CreateString(options->Get(NanNew("sourceMap")));
-    ctx->options.include_paths = CreateString(options->Get(NanNew("paths")));
-    ctx->options.precision = options->Get(NanNew("precision"))->Int32Value();
+    ctx->input_path = CreateString(ctx_w, options->Get(OPTION_KEY(file)));
+    ctx->output_path = CreateString(ctx_w, options->Get(OPTION_KEY(outFile)));
+    ctx->options.image_path = CreateString(ctx_w, options->Get(OPTION_KEY(imagePath)));
+    ctx->options.output_style = options->Get(OPTION_KEY(style))->Int32Value();
+    ctx->options.source_comments = source_comments = options->Get(OPTION_KEY(comments))->BooleanValue();
+    ctx->options.omit_source_map_url = options->Get(OPTION_KEY(omitSourceMapUrl))->BooleanValue();
+    ctx->options.source_map_file = CreateString(ctx_w, options->Get(OPTION_KEY(sourceMap)));
+    ctx->options.include_paths = CreateString(ctx_w, options->Get(OPTION_KEY(paths)));
+    ctx->options.precision = options->Get(OPTION_KEY(precision))->Int32Value();
   } else {
     sass_context* ctx = (sass_context*) cptr;
-    ctx->source_string = CreateString(options->Get(NanNew("data")));
-    ctx->output_path = CreateString(options->Get(NanNew("outFile")));
-    ctx->options.is_indented_syntax_src = options->Get(NanNew("indentedSyntax"))->BooleanValue();
-    ctx->options.image_path = CreateString(options->Get(NanNew("imagePath")));
-    ctx->options.output_style = options->Get(NanNew("style"))->Int32Value();
-    ctx->options.source_comments = source_comments = options->Get(NanNew("comments"))->BooleanValue();
-    ctx->options.omit_source_map_url = options->Get(NanNew("omitSourceMapUrl"))->BooleanValue();
-    ctx->options.source_map_file = CreateString(options->Get(NanNew("sourceMap")));
-    ctx->options.include_paths = CreateString(options->Get(NanNew("paths")));
-    ctx->options.precision = options->Get(NanNew("precision"))->Int32Value();
+    Local<Value> data = options->Get(OPTION_KEY(data));
+
+    // a streamed source is handed over as is rather than copied again
+    if (SourceBuffer::HasInstance(data)) {
+      ctx_w->source = node::ObjectWrap::Unwrap<SourceBuffer>(data->ToObject())->Take();
+      ctx->source_string = ctx_w->source;
+    } else {
+      ctx->source_string = CreateString(ctx_w, data);
+    }
+    ctx->output_path = CreateString(ctx_w, options->Get(OPTION_KEY(outFile)));
+    ctx->options.is_indented_syntax_src = options->Get(OPTION_KEY(indentedSyntax))->BooleanValue();
+    ctx->options.image_path = CreateString(ctx_w, options->Get(OPTION_KEY(imagePath)));
+    ctx->options.output_style = options->Get(OPTION_KEY(style))->Int32Value();
+    ctx->options.source_comments = source_comments = options->Get(OPTION_KEY(comments))->BooleanValue();
+    ctx->options.omit_source_map_url = options->Get(OPTION_KEY(omitSourceMapUrl))->BooleanValue();
+    ctx->options.source_map_file = CreateString(ctx_w, options->Get(OPTION_KEY(sourceMap)));
+    ctx->options.include_paths = CreateString(ctx_w, options->Get(OPTION_KEY(paths)));
+    ctx->options.precision = options->Get(OPTION_KEY(precision))->Int32Value();
   }
+
+  Local<Value> prelude = options->Get(OPTION_KEY(prelude));
+  if (!isFile && Prelude::HasInstance(prelude)) {
+    sass_context* ctx = (sass_context*) cptr;
+    ctx->source_string = node::ObjectWrap::Unwrap<Prelude>(prelude->ToObject())->Prepend(&ctx_w->arena, ctx->source_string);
+  }
+}
+
+double Milliseconds(uint64_t start, uint64_t end) {
+  return (end - start) / 1e6;
+}
+
+// Adds the duration of each native stage to stats: option marshalling,
+// waiting in the compile pool, the libsass compile itself and converting
+// its results up to the point the JS callback is invoked. Skipped, like
+// `includedFiles`, for compiles with `stats: false`.
+void FillTimingStats(Handle<Object> stats, sass_context_wrapper* ctx_w, uint64_t marshal_start, uint64_t queue_start, uint64_t compile_start, uint64_t compile_end, uint64_t callback_start) {
+  if (!ctx_w->collect_stats) {
+    return;
+  }
+
+  stats->Set(OPTION_KEY(marshalMs), NanNew<Number>(Milliseconds(marshal_start, queue_start)));
+  stats->Set(OPTION_KEY(queuedMs), NanNew<Number>(Milliseconds(queue_start, compile_start)));
+  stats->Set(OPTION_KEY(compileMs), NanNew<Number>(Milliseconds(compile_start, compile_end)));
+  stats->Set(OPTION_KEY(callbackMs), NanNew<Number>(Milliseconds(callback_start, uv_hrtime())));
+}
+
+double Microseconds(uint64_t time) {
+  return time / 1e3;
+}
+
+// Hands the start and end of each stage to the tracer as `stats.trace`:
+// the thread, 0 for the loop thread and 1 and up for the compile pool's,
+// then the start of marshalling, queueing and the compile, the end of the
+// compile and of writing output (0 if nothing was written), and the start
+// and end of result conversion and the callback. Times are in microseconds
+// on the clock of `process.hrtime()`. An async compile leaves out the end,
+// which only JS can take once the callback has returned.
+void FillTraceStats(Handle<Object> stats, int thread, uint64_t marshal_start, uint64_t queue_start, uint64_t compile_start, uint64_t compile_end, uint64_t write_end, uint64_t callback_start, uint64_t callback_end) {
+  uint64_t times[] = { marshal_start, queue_start, compile_start, compile_end, write_end, callback_start, callback_end };
+  int count = callback_end ? 7 : 6;
+  Local<Array> trace = NanNew<Array>(count + 1);
+
+  trace->Set(0, NanNew<Integer>(thread));
+  for (int i = 0; i < count; i++) {
+    trace->Set(i + 1, NanNew<Number>(Microseconds(times[i])));
+  }
+
+  stats->Set(OPTION_KEY(trace), trace);
 }
 
+// `includedFiles` is normalized to forward slashes, sorted and deduplicated,
+// and handed over as one NUL-separated string that JS only splits when it
+// is read, rather than as an array of one handle per file.
 template<typename Ctx>
-void FillStatsObj(Handle<Object> stats, Ctx ctx) {
-  int i;
-  Handle<Array> arr;
+void FillStatsObj(Handle<Object> stats, Ctx ctx, bool withIncludedFiles) {
+  if (!withIncludedFiles) {
+    return;
+  }
 
-  arr = NanNew<Array>(ctx->num_included_files);
-  for (i = 0; i < ctx->num_included_files; i++) {
-    arr->Set(i, NanNew<String>(ctx->included_files[i]));
+  set<string> files;
+  for (int i = 0; i < ctx->num_included_files; i++) {
+    string file(ctx->included_files[i]);
+    replace(file.begin(), file.end(), '\\', '/');
+    files.insert(file);
   }
-  (*stats)->Set(NanNew("includedFiles"), arr);
+
+  string joined;
+  for (set<string>::iterator it = files.begin(); it != files.end(); ++it) {
+    if (it != files.begin()) {
+      joined += '\0';
+    }
+    joined += *it;
+  }
+  (*stats)->Set(OPTION_KEY(includedFiles), NanNew<String>(joined.data(), (int) joined.length()));
 }
 
-void FillStatsObj(Handle<Object> stats, sass_file_context* ctx) {
+void FillStatsObj(Handle<Object> stats, sass_file_context* ctx, bool withIncludedFiles, bool withSourceMap = true) {
   Handle<Value> source_map;
 
-  FillStatsObj<sass_file_context*>(stats, ctx);
+  FillStatsObj<sass_file_context*>(stats, ctx, withIncludedFiles);
 
-  if (ctx->error_status) {
+  if (ctx->error_status || !withSourceMap) {
       return;
   }
   if (ctx->source_map_string) {
-    source_map = NanNew<String>(ctx->source_map_string);
+    // handed over without a copy; JS only makes a string of it on access
+    source_map = OutputValue(&ctx->source_map_string, true);
   } else {
     source_map = NanNull();
   }
-  (*stats)->Set(NanNew("sourceMap"), source_map);
+  (*stats)->Set(OPTION_KEY(sourceMap), source_map);
 }
 
-void MakeCallback(uv_work_t* req) {
+Local<Array> StyleValues(sass_context_wrapper* ctx_w, Local<Value> first, char** values, bool asBuffer) {
+  Local<Array> array = NanNew<Array>(ctx_w->num_styles);
+  array->Set(0, first);
+
+  for (int i = 1; i < ctx_w->num_styles; i++) {
+    array->Set(i, values[i] ? OutputValue(&values[i], asBuffer) : NanNull());
+  }
+
+  return array;
+}
+
+// With more than one style, the outputs and source maps of all of them are
+// handed over as arrays in the order the styles were given.
+Local<Value> StyleOutputs(Handle<Object> stats, sass_context_wrapper* ctx_w, Local<Value> output, bool asBuffer) {
+  if (ctx_w->num_styles < 2) {
+    return output;
+  }
+
+  if (ctx_w->fctx) {
+    stats->Set(OPTION_KEY(sourceMap), StyleValues(ctx_w, stats->Get(OPTION_KEY(sourceMap)), ctx_w->source_maps, true));
+  }
+
+  return StyleValues(ctx_w, output, ctx_w->outputs, asBuffer);
+}
+
+// Reports the peak of what libsass allocated during the compile. A compile
+// that ran out of its `maxMemory` is turned into an error by MemoryError.
+void FillMemoryStats(Handle<Object> stats, sass_context_wrapper* ctx_w) {
+  if (!ctx_w->collect_stats) {
+    return;
+  }
+
+  stats->Set(OPTION_KEY(peakMemory), NanNew<Number>((double) ctx_w->memory.peak));
+}
+
+// Finds the `file:line` a libsass message line starts with. The line is
+// the first run of digits after a colon, so drive letters are skipped.
+bool ParseLocation(const string& text, string* file, int* line, size_t* end) {
+  for (size_t colon = text.find(':'); colon != string::npos; colon = text.find(':', colon + 1)) {
+    size_t digits = colon + 1;
+
+    while (digits < text.length() && isdigit((unsigned char) text[digits])) {
+      digits++;
+    }
+
+    if (digits > colon + 1 && colon > 0) {
+      *file = text.substr(0, colon);
+      *line = atoi(text.substr(colon + 1, digits - colon - 1).c_str());
+      *end = digits;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Splits the libsass message of a failed compile, which reads
+// `file:line: error: message`, optionally followed by `Backtrace:` and one
+// `file:line` per import or call, into `file`, `line`, `column`, `message`
+// and `backtrace`. libsass does not report a column here, so it is always
+// `null`.
+Local<Object> ErrorDetails(const char* error_message, int status) {
+  string text(error_message ? error_message : "");
+  size_t newline = text.find('\n');
+  string first = text.substr(0, newline);
+  string message = first;
+  string file;
+  int line = 0;
+  size_t end;
+  bool located = ParseLocation(first, &file, &line, &end);
+
+  if (located && first.compare(end, 9, ": error: ") == 0) {
+    message = first.substr(end + 9);
+  } else if (located && first.compare(end, 2, ": ") == 0) {
+    message = first.substr(end + 2);
+  }
+
+  Local<Object> error = NanNew<Object>();
+  Local<Array> backtrace = NanNew<Array>();
+
+  error->Set(OPTION_KEY(message), NanNew<String>(message.c_str()));
+  error->Set(OPTION_KEY(file), located ? (Local<Value>) NanNew<String>(file.c_str()) : (Local<Value>) NanNull());
+  error->Set(OPTION_KEY(line), located ? (Local<Value>) NanNew<Integer>(line) : (Local<Value>) NanNull());
+  error->Set(OPTION_KEY(column), NanNull());
+  error->Set(OPTION_KEY(status), NanNew<Integer>(status));
+
+  size_t pos = text.find("Backtrace:");
+  pos = pos == string::npos ? pos : text.find('\n', pos);
+
+  while (pos != string::npos) {
+    size_t stop = text.find('\n', pos + 1);
+    string entry = text.substr(pos + 1, stop == string::npos ? string::npos : stop - pos - 1);
+    string entry_file;
+    int entry_line;
+
+    entry.erase(0, entry.find_first_not_of(" \t"));
+    if (ParseLocation(entry, &entry_file, &entry_line, &end)) {
+      Local<Object> frame = NanNew<Object>();
+      frame->Set(OPTION_KEY(file), NanNew<String>(entry_file.c_str()));
+      frame->Set(OPTION_KEY(line), NanNew<Integer>(entry_line));
+      backtrace->Set(backtrace->Length(), frame);
+    }
+
+    pos = stop;
+  }
+
+  error->Set(OPTION_KEY(backtrace), backtrace);
+  return error;
+}
+
+// The Error thrown by the sync compiles keeps the whole message and
+// carries the details besides it.
+Local<Object> DetailedError(const char* message, Local<Object> details) {
+  Local<Object> error = NanError(message)->ToObject();
+  Local<Array> keys = details->GetOwnPropertyNames();
+
+  for (uint32_t i = 0; i < keys->Length(); i++) {
+    Local<Value> key = keys->Get(i);
+
+    if (!key->Equals(OPTION_KEY(message))) {
+      error->Set(key, details->Get(key));
+    }
+  }
+
+  return error;
+}
+
+Local<Object> CompileError(const char* error_message, int status) {
+  return DetailedError(error_message ? error_message : "", ErrorDetails(error_message, status));
+}
+
+string MemoryMessage(sass_context_wrapper* ctx_w) {
+  char message[128];
+  sprintf(message, "Compile exceeded `maxMemory` of %lu bytes", (unsigned long) ctx_w->memory.limit);
+  return message;
+}
+
+// Like the errors node-sass raises itself, such as `ECANCELED`, a compile
+// that ran out of its `maxMemory` has a string status, `ENOMEM`, and no
+// location.
+Local<Object> MemoryDetails(sass_context_wrapper* ctx_w) {
+  Local<Object> details = NanNew<Object>();
+
+  details->Set(OPTION_KEY(message), NanNew<String>(MemoryMessage(ctx_w).c_str()));
+  details->Set(OPTION_KEY(file), NanNull());
+  details->Set(OPTION_KEY(line), NanNull());
+  details->Set(OPTION_KEY(column), NanNull());
+  details->Set(OPTION_KEY(status), NanNew<String>("ENOMEM"));
+  details->Set(OPTION_KEY(backtrace), NanNew<Array>());
+  return details;
+}
+
+Local<Object> MemoryError(sass_context_wrapper* ctx_w) {
+  return DetailedError(MemoryMessage(ctx_w).c_str(), MemoryDetails(ctx_w));
+}
+
+void MakeCallback(uv_work_t* req, int status) {
   NanScope();
 
-  TryCatch try_catch;
+  uint64_t callback_start = uv_hrtime();
   sass_context_wrapper* ctx_w = static_cast<sass_context_wrapper*>(req->data);
+  inflight.erase(ctx_w->id);
+
+  // dropped before it started; the JS side has already reported it
+  if (status == UV_ECANCELED) {
+    sass_free_context_wrapper(ctx_w);
+    return;
+  }
+
+  TryCatch try_catch;
   int error_status = ctx_w->ctx ? ctx_w->ctx->error_status : ctx_w->fctx->error_status;
+  Local<Object> stats = NanNew(ctx_w->stats);
+  NanCallback* callback;
+  Local<Value> argv[3];
+  int argc = 2;
 
   if (ctx_w->ctx) {
-    FillStatsObj(NanNew(ctx_w->stats), ctx_w->ctx);
+    FillStatsObj(stats, ctx_w->ctx, ctx_w->collect_stats);
   } else {
-    FillStatsObj(NanNew(ctx_w->stats), ctx_w->fctx);
+    FillStatsObj(stats, ctx_w->fctx, ctx_w->collect_stats, !ctx_w->css_path);
   }
 
-  if (error_status == 0) {
+  if (ctx_w->memory.exceeded) {
+    callback = ctx_w->errorCallback;
+    argv[0] = NanNew<String>(MemoryMessage(ctx_w).c_str());
+    argv[1] = NanNew<String>("ENOMEM");
+    argv[2] = MemoryDetails(ctx_w);
+    argc = 3;
+  } else if (ctx_w->write_error) {
+    // the compile succeeded but writing its output, or a further style, did not
+    callback = ctx_w->errorCallback;
+    argv[0] = NanError(ctx_w->write_error);
+    argc = 1;
+  } else if (error_status == 0 && ctx_w->css_path) {
+    // output was written by the worker, only stats are handed back
+    callback = ctx_w->callback;
+    argv[0] = NanNull();
+    argv[1] = NanNull();
+  } else if (error_status == 0) {
     // if no error, do callback(null, result)
-    char* val = ctx_w->ctx ? ctx_w->ctx->output_string : ctx_w->fctx->output_string;
-    Local<Value> argv[] = {
-      NanNew<String>(val),
-      NanNew(ctx_w->stats)->Get(NanNew("sourceMap"))
-    };
-    ctx_w->callback->Call(2, argv);
+    char** val = ctx_w->ctx ? &ctx_w->ctx->output_string : &ctx_w->fctx->output_string;
+    callback = ctx_w->callback;
+    argv[0] = StyleOutputs(stats, ctx_w, OutputValue(val, ctx_w->output_buffer), ctx_w->output_buffer);
+    argv[1] = stats->Get(OPTION_KEY(sourceMap));
   } else {
     // if error, do callback(error)
     char* err = ctx_w->ctx ? ctx_w->ctx->error_message : ctx_w->fctx->error_message;
-    Local<Value> argv[] = {
-      NanNew<String>(err),
-      NanNew<Integer>(error_status)
-    };
-    ctx_w->errorCallback->Call(2, argv);
+    callback = ctx_w->errorCallback;
+    argv[0] = NanNew<String>(err);
+    argv[1] = NanNew<Integer>(error_status);
+    argv[2] = ErrorDetails(err, error_status);
+    argc = 3;
+  }
+
+  if (ctx_w->write_end && ctx_w->collect_stats) {
+    stats->Set(OPTION_KEY(writeMs), NanNew<Number>(Milliseconds(ctx_w->compile_end, ctx_w->write_end)));
+  }
+  FillTimingStats(stats, ctx_w, ctx_w->marshal_start, ctx_w->queue_start, ctx_w->compile_start, ctx_w->compile_end, callback_start);
+
+  if (ctx_w->trace) {
+    FillTraceStats(stats, ctx_w->thread, ctx_w->marshal_start, ctx_w->queue_start, ctx_w->compile_start, ctx_w->compile_end, ctx_w->write_end, callback_start, 0);
   }
+  FillMemoryStats(stats, ctx_w);
+
+  callback->Call(argc, argv);
   if (try_catch.HasCaught()) {
     node::FatalException(try_catch);
   }
   sass_free_context_wrapper(ctx_w);
 }
 
+uint32_t QueueContext(sass_context_wrapper* ctx_w, uint64_t marshal_start) {
+  ctx_w->marshal_start = marshal_start;
+  ctx_w->queue_start = uv_hrtime();
+  ctx_w->id = ++next_id;
+  inflight[ctx_w->id] = ctx_w;
+
+  int status = compile_pool_queue(&ctx_w->request, WorkOnContext, MakeCallback);
+  assert(status == 0);
+
+  return ctx_w->id;
+}
+
 NAN_METHOD(Render) {
   NanScope();
 
+  uint64_t marshal_start = uv_hrtime();
   sass_context* ctx = sass_new_context();
   sass_context_wrapper* ctx_w = sass_new_context_wrapper();
-  ctx_w->ctx = ctx;
-  ExtractOptions(args[0], ctx, ctx_w, false);
+  ExtractOptions(args[0], ctx, ctx_w, false, true);
 
-  int status = uv_queue_work(uv_default_loop(), &ctx_w->request, WorkOnContext, (uv_after_work_cb)MakeCallback);
-  assert(status == 0);
-
-  NanReturnUndefined();
+  NanReturnValue(NanNew<Number>(QueueContext(ctx_w, marshal_start)));
 }
 
 NAN_METHOD(RenderSync) {
   NanScope();
+
+  uint64_t marshal_start = uv_hrtime();
   Handle<Object> options = args[0]->ToObject();
   sass_context* ctx = sass_new_context();
-  ExtractOptions(args[0], ctx, NULL, false);
+  sass_context_wrapper* ctx_w = sass_new_context_wrapper();
+  ExtractOptions(args[0], ctx, ctx_w, false, false);
+  uint64_t compile_start = uv_hrtime();
+  sass_memory_budget_enter(&ctx_w->memory);
 
   sass_compile(ctx);
+  if (ctx->error_status == 0) {
+    CompileStyles(ctx_w);
+  }
 
-  FillStatsObj(options->Get(NanNew("stats"))->ToObject(), ctx);
+  sass_memory_budget_enter(NULL);
+  uint64_t compile_end = uv_hrtime();
 
-  if (ctx->error_status == 0) {
-    Local<String> output = NanNew<String>(ctx->output_string);
-    free_context(ctx);
+  Handle<Object> stats = options->Get(OPTION_KEY(stats))->ToObject();
+  FillStatsObj(stats, ctx, ctx_w->collect_stats);
+
+  if (ctx->error_status == 0 && !ctx_w->write_error && !ctx_w->memory.exceeded) {
+    bool asBuffer = options->Get(OPTION_KEY(outputBuffer))->BooleanValue();
+    Local<Value> output = StyleOutputs(stats, ctx_w, OutputValue(&ctx->output_string, asBuffer), asBuffer);
+    FillTimingStats(stats, ctx_w, marshal_start, compile_start, compile_start, compile_end, compile_end);
+
+    if (ctx_w->trace) {
+      FillTraceStats(stats, 0, marshal_start, compile_start, compile_start, compile_end, 0, compile_end, uv_hrtime());
+    }
+    FillMemoryStats(stats, ctx_w);
+    sass_free_context_wrapper(ctx_w);
     NanReturnValue(output);
   }
 
-  Local<String> error = NanNew<String>(ctx->error_message);
-  free_context(ctx);
+  Local<Value> error = ctx_w->memory.exceeded ? (Local<Value>) MemoryError(ctx_w) :
+    ctx_w->write_error ? NanError(ctx_w->write_error) :
+    (Local<Value>) CompileError(ctx->error_message, ctx->error_status);
+  FillTimingStats(stats, ctx_w, marshal_start, compile_start, compile_start, compile_end, compile_end);
+
+  if (ctx_w->trace) {
+    FillTraceStats(stats, 0, marshal_start, compile_start, compile_start, compile_end, 0, compile_end, uv_hrtime());
+  }
+  FillMemoryStats(stats, ctx_w);
+  sass_free_context_wrapper(ctx_w);
   NanThrowError(error);
   NanReturnUndefined();
 }
 
 NAN_METHOD(RenderFile) {
   NanScope();
+
+  uint64_t marshal_start = uv_hrtime();
   sass_file_context* fctx = sass_new_file_context();
   sass_context_wrapper* ctx_w = sass_new_context_wrapper();
-  ctx_w->fctx = fctx;
-  ExtractOptions(args[0], fctx, ctx_w, true);
+  ExtractOptions(args[0], fctx, ctx_w, true, true);
 
-  int status = uv_queue_work(uv_default_loop(), &ctx_w->request, WorkOnContext, (uv_after_work_cb)MakeCallback);
-  assert(status == 0);
+  NanReturnValue(NanNew<Number>(QueueContext(ctx_w, marshal_start)));
+}
 
-  NanReturnUndefined();
+NAN_METHOD(RenderBatch) {
+  NanScope();
+  Local<Array> batch = Local<Array>::Cast(args[0]);
+  Local<Array> ids = NanNew<Array>(batch->Length());
+
+  for (uint32_t i = 0; i < batch->Length(); i++) {
+    uint64_t marshal_start = uv_hrtime();
+    Local<Value> options = batch->Get(i);
+    sass_context_wrapper* ctx_w = sass_new_context_wrapper();
+
+    if (options->ToObject()->Get(OPTION_KEY(file))->IsString()) {
+      ExtractOptions(options, sass_new_file_context(), ctx_w, true, true);
+    } else {
+      ExtractOptions(options, sass_new_context(), ctx_w, false, true);
+    }
+
+    ids->Set(i, NanNew<Number>(QueueContext(ctx_w, marshal_start)));
+  }
+
+  NanReturnValue(ids);
 }
 
 NAN_METHOD(RenderFileSync) {
   NanScope();
+
+  uint64_t marshal_start = uv_hrtime();
   sass_file_context* ctx = sass_new_file_context();
-  ExtractOptions(args[0], ctx, NULL, true);
+  sass_context_wrapper* ctx_w = sass_new_context_wrapper();
+  ExtractOptions(args[0], ctx, ctx_w, true, false);
   Handle<Object> options = args[0]->ToObject();
+  uint64_t compile_start = uv_hrtime();
+  sass_memory_budget_enter(&ctx_w->memory);
 
   sass_compile_file(ctx);
+  if (ctx->error_status == 0) {
+    CompileStyles(ctx_w);
+  }
 
-  FillStatsObj(options->Get(NanNew("stats"))->ToObject(), ctx);
+  sass_memory_budget_enter(NULL);
+  uint64_t compile_end = uv_hrtime();
 
-  if (ctx->error_status == 0) {
-    Local<String> output = NanNew<String>(ctx->output_string);
-    free_file_context(ctx);
+  Handle<Object> stats = options->Get(OPTION_KEY(stats))->ToObject();
+  FillStatsObj(stats, ctx, ctx_w->collect_stats);
+
+  if (ctx->error_status == 0 && !ctx_w->write_error && !ctx_w->memory.exceeded) {
+    bool asBuffer = options->Get(OPTION_KEY(outputBuffer))->BooleanValue();
+    Local<Value> output = StyleOutputs(stats, ctx_w, OutputValue(&ctx->output_string, asBuffer), asBuffer);
+    FillTimingStats(stats, ctx_w, marshal_start, compile_start, compile_start, compile_end, compile_end);
+
+    if (ctx_w->trace) {
+      FillTraceStats(stats, 0, marshal_start, compile_start, compile_start, compile_end, 0, compile_end, uv_hrtime());
+    }
+    FillMemoryStats(stats, ctx_w);
+    sass_free_context_wrapper(ctx_w);
     NanReturnValue(output);
   }
 
-  Local<String> error = NanNew<String>(ctx->error_message);
-  free_file_context(ctx);
+  Local<Value> error = ctx_w->memory.exceeded ? (Local<Value>) MemoryError(ctx_w) :
+    ctx_w->write_error ? NanError(ctx_w->write_error) :
+    (Local<Value>) CompileError(ctx->error_message, ctx->error_status);
+  FillTimingStats(stats, ctx_w, marshal_start, compile_start, compile_start, compile_end, compile_end);
+
+  if (ctx_w->trace) {
+    FillTraceStats(stats, 0, marshal_start, compile_start, compile_start, compile_end, 0, compile_end, uv_hrtime());
+  }
+  FillMemoryStats(stats, ctx_w);
+  sass_free_context_wrapper(ctx_w);
   NanThrowError(error);
   NanReturnUndefined();
 }
 
+NAN_METHOD(Cancel) {
+  NanScope();
+
+  map<uint32_t, sass_context_wrapper*>::iterator it = inflight.find(args[0]->Uint32Value());
+  bool cancelled = it != inflight.end() && compile_pool_cancel(&it->second->request) == 0;
+
+  // already running: it finishes, but must not write its output
+  if (it != inflight.end() && !cancelled) {
+    uv_mutex_lock(&cancel_mutex);
+    it->second->cancelled = true;
+    uv_mutex_unlock(&cancel_mutex);
+  }
+
+  NanReturnValue(NanNew<Boolean>(cancelled));
+}
+
+NAN_METHOD(SetConcurrency) {
+  NanScope();
+  compile_pool_set_concurrency(args[0]->Uint32Value());
+  NanReturnUndefined();
+}
+
+NAN_METHOD(GetConcurrency) {
+  NanScope();
+  NanReturnValue(NanNew<Integer>((int) compile_pool_concurrency()));
+}
+
 void RegisterModule(v8::Handle<v8::Object> target) {
+  InitOptionKeys();
+  uv_mutex_init(&cancel_mutex);
+  compile_pool_init(uv_default_loop());
+  CompiledOptions::Init(target);
+  Prelude::Init(target);
+  SourceBuffer::Init(target);
+  Watcher::Init(target);
+
   NODE_SET_METHOD(target, "render", Render);
   NODE_SET_METHOD(target, "renderSync", RenderSync);
   NODE_SET_METHOD(target, "renderFile", RenderFile);
   NODE_SET_METHOD(target, "renderFileSync", RenderFileSync);
+  NODE_SET_METHOD(target, "renderBatch", RenderBatch);
+  NODE_SET_METHOD(target, "cancel", Cancel);
+  NODE_SET_METHOD(target, "setConcurrency", SetConcurrency);
+  NODE_SET_METHOD(target, "getConcurrency", GetConcurrency);
 }
 
 NODE_MODULE(binding, RegisterModule);
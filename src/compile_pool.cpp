@@ -0,0 +1,162 @@
+#include "compile_pool.h"
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+  uv_loop_t* loop;
+  uv_async_t async;
+  uv_mutex_t mutex;
+  uv_cond_t cond;
+
+  // finished requests are paired with the status for `after_work_cb`
+  typedef pair<uv_work_t*, int> Result;
+
+  deque<uv_work_t*> pending;
+  deque<Result> finished;
+  vector<uv_thread_t*> threads;
+
+  // the request each thread is working on, by thread index
+  vector<uv_work_t*> running;
+
+  // guarded by `mutex`
+  unsigned int concurrency = 4;
+
+  // only touched on the loop thread
+  unsigned int outstanding = 0;
+
+  void Worker(void* arg) {
+    unsigned int index = (unsigned int) (size_t) arg;
+
+    uv_mutex_lock(&mutex);
+    for (;;) {
+      // threads beyond the current concurrency stay parked until it grows
+      while (pending.empty() || index >= concurrency) {
+        uv_cond_wait(&cond, &mutex);
+      }
+
+      uv_work_t* req = pending.front();
+      pending.pop_front();
+      running[index] = req;
+      uv_mutex_unlock(&mutex);
+
+      req->work_cb(req);
+
+      uv_mutex_lock(&mutex);
+      running[index] = NULL;
+      finished.push_back(Result(req, 0));
+      uv_async_send(&async);
+    }
+  }
+
+#if UV_VERSION_MAJOR == 0 && UV_VERSION_MINOR < 11
+  void AfterWork(uv_async_t* handle, int status) {
+#else
+  void AfterWork(uv_async_t* handle) {
+#endif
+    deque<Result> done;
+
+    uv_mutex_lock(&mutex);
+    done.swap(finished);
+    uv_mutex_unlock(&mutex);
+
+    while (!done.empty()) {
+      Result result = done.front();
+      done.pop_front();
+
+      if (--outstanding == 0) {
+        uv_unref((uv_handle_t*) &async);
+      }
+
+      result.first->after_work_cb(result.first, result.second);
+    }
+  }
+
+  // must be called with `mutex` held
+  void SpawnThreads() {
+    while (threads.size() < concurrency) {
+      uv_thread_t* thread = new uv_thread_t;
+      running.push_back(NULL);
+      uv_thread_create(thread, Worker, (void*) (size_t) threads.size());
+      threads.push_back(thread);
+    }
+  }
+}
+
+void compile_pool_init(uv_loop_t* l) {
+  loop = l;
+  uv_mutex_init(&mutex);
+  uv_cond_init(&cond);
+  uv_async_init(loop, &async, AfterWork);
+
+  // an idle pool must not keep the process alive
+  uv_unref((uv_handle_t*) &async);
+}
+
+int compile_pool_queue(uv_work_t* req, uv_work_cb work_cb, uv_after_work_cb after_work_cb) {
+  req->loop = loop;
+  req->work_cb = work_cb;
+  req->after_work_cb = after_work_cb;
+
+  if (outstanding++ == 0) {
+    uv_ref((uv_handle_t*) &async);
+  }
+
+  uv_mutex_lock(&mutex);
+  SpawnThreads();
+  pending.push_back(req);
+
+  // parked threads share the condition, so a single signal could be lost
+  uv_cond_broadcast(&cond);
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+int compile_pool_cancel(uv_work_t* req) {
+  uv_mutex_lock(&mutex);
+  deque<uv_work_t*>::iterator it = find(pending.begin(), pending.end(), req);
+  bool queued = it != pending.end();
+
+  if (queued) {
+    pending.erase(it);
+    finished.push_back(Result(req, UV_ECANCELED));
+    uv_async_send(&async);
+  }
+  uv_mutex_unlock(&mutex);
+
+  return queued ? 0 : -1;
+}
+
+int compile_pool_thread(uv_work_t* req) {
+  uv_mutex_lock(&mutex);
+  int index = (int) (find(running.begin(), running.end(), req) - running.begin());
+  bool found = index < (int) running.size();
+  uv_mutex_unlock(&mutex);
+
+  return found ? index : -1;
+}
+
+void compile_pool_set_concurrency(unsigned int size) {
+  uv_mutex_lock(&mutex);
+  concurrency = size > 0 ? size : 1;
+
+  // threads are spawned lazily on the next queued job; parked threads with
+  // an index below the new size need waking now
+  if (!threads.empty()) {
+    SpawnThreads();
+  }
+  uv_cond_broadcast(&cond);
+  uv_mutex_unlock(&mutex);
+}
+
+unsigned int compile_pool_concurrency() {
+  uv_mutex_lock(&mutex);
+  unsigned int size = concurrency;
+  uv_mutex_unlock(&mutex);
+
+  return size;
+}
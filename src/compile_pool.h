@@ -0,0 +1,20 @@
+#ifndef COMPILE_POOL_H
+#define COMPILE_POOL_H
+
+#include <uv.h>
+
+// A fixed-size pool of compile threads owned by the binding, so Sass jobs do
+// not compete with fs, DNS and zlib for the shared libuv thread pool. Queued
+// requests run `work_cb` on a pool thread and `after_work_cb` on `loop`,
+// mirroring `uv_queue_work`.
+
+void compile_pool_init(uv_loop_t* loop);
+int compile_pool_queue(uv_work_t* req, uv_work_cb work_cb, uv_after_work_cb after_work_cb);
+int compile_pool_cancel(uv_work_t* req);
+
+// Index of the pool thread running `req`, or -1 if none is.
+int compile_pool_thread(uv_work_t* req);
+void compile_pool_set_concurrency(unsigned int size);
+unsigned int compile_pool_concurrency(void);
+
+#endif
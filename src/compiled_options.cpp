@@ -0,0 +1,86 @@
+#include "compiled_options.h"
+
+using namespace v8;
+using namespace std;
+
+#define SASS_DEFINE_OPTION_KEY(name) Persistent<String> name##_key;
+SASS_OPTION_KEYS(SASS_DEFINE_OPTION_KEY)
+#undef SASS_DEFINE_OPTION_KEY
+
+void InitOptionKeys() {
+#define SASS_INIT_OPTION_KEY(name) NanAssignPersistent(name##_key, NanNew(#name));
+  SASS_OPTION_KEYS(SASS_INIT_OPTION_KEY)
+#undef SASS_INIT_OPTION_KEY
+}
+
+Persistent<FunctionTemplate> CompiledOptions::constructor;
+
+static string ToString(Local<Value> value) {
+  if (!value->IsString()) {
+    return string();
+  }
+
+  String::Utf8Value str(value);
+  return string(*str, str.length());
+}
+
+CompiledOptions::CompiledOptions(Handle<Object> options) {
+  data = ToString(options->Get(OPTION_KEY(data)));
+  file = ToString(options->Get(OPTION_KEY(file)));
+  out_file = ToString(options->Get(OPTION_KEY(outFile)));
+  image_path = ToString(options->Get(OPTION_KEY(imagePath)));
+  source_map = ToString(options->Get(OPTION_KEY(sourceMap)));
+  paths = ToString(options->Get(OPTION_KEY(paths)));
+  style = options->Get(OPTION_KEY(style))->Int32Value();
+  precision = options->Get(OPTION_KEY(precision))->Int32Value();
+  comments = options->Get(OPTION_KEY(comments))->BooleanValue();
+  omit_source_map_url = options->Get(OPTION_KEY(omitSourceMapUrl))->BooleanValue();
+  indented_syntax = options->Get(OPTION_KEY(indentedSyntax))->BooleanValue();
+}
+
+void CompiledOptions::Init(Handle<Object> target) {
+  Local<FunctionTemplate> tpl = NanNew<FunctionTemplate>(New);
+  tpl->SetClassName(NanNew("CompiledOptions"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NanAssignPersistent(constructor, tpl);
+  target->Set(NanNew("CompiledOptions"), tpl->GetFunction());
+}
+
+bool CompiledOptions::HasInstance(Handle<Value> value) {
+  return value->IsObject() && NanNew(constructor)->HasInstance(value);
+}
+
+NAN_METHOD(CompiledOptions::New) {
+  NanScope();
+
+  CompiledOptions* options = new CompiledOptions(args[0]->ToObject());
+  options->Wrap(args.This());
+
+  NanReturnValue(args.This());
+}
+
+void CompiledOptions::Apply(sass_context* ctx) {
+  ctx->source_string = const_cast<char*>(data.c_str());
+  ctx->output_path = const_cast<char*>(out_file.c_str());
+  ctx->options.is_indented_syntax_src = indented_syntax;
+  ctx->options.image_path = const_cast<char*>(image_path.c_str());
+  ctx->options.output_style = style;
+  ctx->options.source_comments = comments;
+  ctx->options.omit_source_map_url = omit_source_map_url;
+  ctx->options.source_map_file = const_cast<char*>(source_map.c_str());
+  ctx->options.include_paths = const_cast<char*>(paths.c_str());
+  ctx->options.precision = precision;
+}
+
+void CompiledOptions::Apply(sass_file_context* ctx) {
+  ctx->input_path = const_cast<char*>(file.c_str());
+  ctx->output_path = const_cast<char*>(out_file.c_str());
+  ctx->options.image_path = const_cast<char*>(image_path.c_str());
+  ctx->options.output_style = style;
+  ctx->options.source_comments = comments;
+  ctx->options.omit_source_map_url = omit_source_map_url;
+  ctx->options.source_map_file = const_cast<char*>(source_map.c_str());
+  ctx->options.include_paths = const_cast<char*>(paths.c_str());
+  ctx->options.precision = precision;
+}
@@ -0,0 +1,87 @@
+#ifndef COMPILED_OPTIONS_H
+#define COMPILED_OPTIONS_H
+
+#include <nan.h>
+#include <node_object_wrap.h>
+#include <string>
+#include "libsass/sass_interface.h"
+
+// Every option and stats property name the binding uses. They are interned
+// once on load, so marshalling an options object does not allocate a handle
+// string for each lookup.
+#define SASS_OPTION_KEYS(V) \
+  V(backtrace) \
+  V(callbackMs) \
+  V(collectStats) \
+  V(column) \
+  V(comments) \
+  V(compileMs) \
+  V(compiled) \
+  V(css) \
+  V(data) \
+  V(error) \
+  V(file) \
+  V(imagePath) \
+  V(includedFiles) \
+  V(indentedSyntax) \
+  V(line) \
+  V(marshalMs) \
+  V(maxMemory) \
+  V(message) \
+  V(omitSourceMapUrl) \
+  V(outFile) \
+  V(outputBuffer) \
+  V(peakMemory) \
+  V(paths) \
+  V(precision) \
+  V(prelude) \
+  V(queuedMs) \
+  V(sourceMap) \
+  V(stats) \
+  V(status) \
+  V(style) \
+  V(styles) \
+  V(success) \
+  V(trace) \
+  V(writeMs) \
+  V(writeToDisk)
+
+#define SASS_DECLARE_OPTION_KEY(name) extern v8::Persistent<v8::String> name##_key;
+SASS_OPTION_KEYS(SASS_DECLARE_OPTION_KEY)
+#undef SASS_DECLARE_OPTION_KEY
+
+#define OPTION_KEY(name) NanNew(name##_key)
+
+void InitOptionKeys();
+
+// Options marshalled into native form once by `sass.createOptions()`. Their
+// strings are lent to every context compiled from them instead of being
+// copied per compile; contexts never free their option strings themselves.
+class CompiledOptions : public node::ObjectWrap {
+  public:
+    static void Init(v8::Handle<v8::Object> target);
+    static bool HasInstance(v8::Handle<v8::Value> value);
+
+    void Apply(sass_context* ctx);
+    void Apply(sass_file_context* ctx);
+
+  private:
+    explicit CompiledOptions(v8::Handle<v8::Object> options);
+
+    static NAN_METHOD(New);
+    static v8::Persistent<v8::FunctionTemplate> constructor;
+
+    std::string data;
+    std::string file;
+    std::string out_file;
+    std::string image_path;
+    std::string source_map;
+    std::string paths;
+    int style;
+    int precision;
+    bool comments;
+    bool omit_source_map_url;
+    bool indented_syntax;
+};
+
+#endif
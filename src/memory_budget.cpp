@@ -0,0 +1,142 @@
+#include "memory_budget.h"
+#include <cstdlib>
+#include <new>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#include <pthread.h>
+#define SASS_USABLE_SIZE(p) malloc_size(p)
+#elif defined(_WIN32)
+#include <malloc.h>
+#define SASS_USABLE_SIZE(p) _msize(p)
+#else
+#include <malloc.h>
+#define SASS_USABLE_SIZE(p) malloc_usable_size(p)
+#endif
+
+// dynamic exception specifications are deprecated from C++11 on
+#if __cplusplus < 201103L
+#define SASS_THROWS_BAD_ALLOC throw(std::bad_alloc)
+#define SASS_NOEXCEPT throw()
+#else
+#define SASS_THROWS_BAD_ALLOC
+#define SASS_NOEXCEPT noexcept
+#endif
+
+namespace {
+  // thread-local storage with `__thread` is missing from older OS X
+  // toolchains, so a pthread key is used there
+#if defined(__APPLE__)
+  pthread_key_t key;
+  pthread_once_t once = PTHREAD_ONCE_INIT;
+
+  void CreateKey() {
+    pthread_key_create(&key, NULL);
+  }
+
+  sass_memory_budget* Current() {
+    pthread_once(&once, CreateKey);
+    return static_cast<sass_memory_budget*>(pthread_getspecific(key));
+  }
+
+  void SetCurrent(sass_memory_budget* budget) {
+    pthread_once(&once, CreateKey);
+    pthread_setspecific(key, budget);
+  }
+#else
+#if defined(_MSC_VER)
+  __declspec(thread) sass_memory_budget* current = NULL;
+#else
+  __thread sass_memory_budget* current = NULL;
+#endif
+
+  sass_memory_budget* Current() {
+    return current;
+  }
+
+  void SetCurrent(sass_memory_budget* budget) {
+    current = budget;
+  }
+#endif
+
+  void* Allocate(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    sass_memory_budget* budget = Current();
+
+    if (!ptr || !budget) {
+      return ptr;
+    }
+
+    size_t usable = SASS_USABLE_SIZE(ptr);
+
+    // the limit trips once; libsass allocates while it unwinds and builds
+    // its error message, and a second `bad_alloc` there would escape the
+    // compile and terminate the process
+    if (budget->limit && !budget->exceeded && budget->used + usable > budget->limit) {
+      free(ptr);
+      budget->exceeded = true;
+      return NULL;
+    }
+
+    budget->used += usable;
+    if (budget->used > budget->peak) {
+      budget->peak = budget->used;
+    }
+
+    return ptr;
+  }
+
+  void Release(void* ptr) {
+    sass_memory_budget* budget = Current();
+
+    if (ptr && budget) {
+      size_t usable = SASS_USABLE_SIZE(ptr);
+      // memory allocated before the budget was entered may be freed in it
+      budget->used = budget->used > usable ? budget->used - usable : 0;
+    }
+
+    free(ptr);
+  }
+}
+
+void sass_memory_budget_enter(sass_memory_budget* budget) {
+  SetCurrent(budget);
+}
+
+void* operator new(size_t size) SASS_THROWS_BAD_ALLOC {
+  void* ptr = Allocate(size);
+
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+
+  return ptr;
+}
+
+void* operator new[](size_t size) SASS_THROWS_BAD_ALLOC {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) SASS_NOEXCEPT {
+  return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) SASS_NOEXCEPT {
+  return Allocate(size);
+}
+
+void operator delete(void* ptr) SASS_NOEXCEPT {
+  Release(ptr);
+}
+
+void operator delete[](void* ptr) SASS_NOEXCEPT {
+  Release(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) SASS_NOEXCEPT {
+  Release(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) SASS_NOEXCEPT {
+  Release(ptr);
+}
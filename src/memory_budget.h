@@ -0,0 +1,21 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <cstddef>
+
+// Accounts for the memory libsass allocates during one compile. The binding
+// replaces `operator new`, so every allocation made on a thread while a
+// budget is active is counted against it. The first one that would take
+// it past its limit throws `std::bad_alloc`, which libsass reports as a
+// failed compile; later ones succeed so that can finish.
+struct sass_memory_budget {
+  size_t limit;
+  size_t used;
+  size_t peak;
+  bool exceeded;
+};
+
+// Makes `budget` the active one of the calling thread, or none if NULL.
+void sass_memory_budget_enter(sass_memory_budget* budget);
+
+#endif
@@ -0,0 +1,48 @@
+#include "prelude.h"
+#include <cstring>
+
+using namespace v8;
+using namespace std;
+
+Persistent<FunctionTemplate> Prelude::constructor;
+
+Prelude::Prelude(const string& source) : source(source) {}
+
+void Prelude::Init(Handle<Object> target) {
+  Local<FunctionTemplate> tpl = NanNew<FunctionTemplate>(New);
+  tpl->SetClassName(NanNew("Prelude"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NanAssignPersistent(constructor, tpl);
+  target->Set(NanNew("Prelude"), tpl->GetFunction());
+}
+
+bool Prelude::HasInstance(Handle<Value> value) {
+  return value->IsObject() && NanNew(constructor)->HasInstance(value);
+}
+
+char* Prelude::Prepend(sass_arena* arena, const char* suffix) {
+  size_t length = strlen(suffix);
+  char* joined = sass_arena_alloc(arena, source.length() + 1 + length);
+
+  // the newline ends a last line of the prelude without one
+  memcpy(joined, source.data(), source.length());
+  joined[source.length()] = '\n';
+  memcpy(joined + source.length() + 1, suffix, length);
+
+  return joined;
+}
+
+NAN_METHOD(Prelude::New) {
+  NanScope();
+
+  if (!args[0]->IsString()) {
+    return NanThrowTypeError("source must be a string");
+  }
+
+  String::Utf8Value source(args[0]);
+  Prelude* prelude = new Prelude(string(*source, source.length()));
+  prelude->Wrap(args.This());
+
+  NanReturnValue(args.This());
+}
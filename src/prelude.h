@@ -0,0 +1,29 @@
+#ifndef PRELUDE_H
+#define PRELUDE_H
+
+#include <nan.h>
+#include <node_object_wrap.h>
+#include <string>
+#include "sass_context_wrapper.h"
+
+// Source shared by the start of many `data` compiles, such as the imports
+// of a framework, made by `sass.createPrelude()`. It is converted to UTF-8
+// once and prepended natively, so a compile only marshals its own suffix.
+class Prelude : public node::ObjectWrap {
+  public:
+    static void Init(v8::Handle<v8::Object> target);
+    static bool HasInstance(v8::Handle<v8::Value> value);
+
+    // Returns the prelude followed by `suffix`, allocated from `arena`.
+    char* Prepend(sass_arena* arena, const char* suffix);
+
+  private:
+    explicit Prelude(const std::string& source);
+
+    static NAN_METHOD(New);
+    static v8::Persistent<v8::FunctionTemplate> constructor;
+
+    std::string source;
+};
+
+#endif
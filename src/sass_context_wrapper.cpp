@@ -1,25 +1,98 @@
 #include "sass_context_wrapper.h"
 #include <nan.h>
 #include <cstdlib>
+#include <cstring>
+
+// wrappers kept for reuse; more than this are freed
+#define SASS_WRAPPER_POOL_SIZE 64
+
+// size of the first arena chunk, enough for the options of most compiles
+#define SASS_ARENA_CHUNK_SIZE 1024
+
+// largest chunk a pooled wrapper keeps; one that held a big source is
+// freed rather than pinned for the life of the process
+#define SASS_ARENA_KEEP_SIZE 65536
 
 extern "C" {
   using namespace std;
 
+  static sass_context_wrapper* pool[SASS_WRAPPER_POOL_SIZE];
+  static int pooled = 0;
+
+  // option strings are owned by the wrapper's arena, and the rest of the
+  // context by libsass
   void free_context(sass_context* ctx) {
-    delete[] ctx->source_string;
-    delete[] ctx->options.include_paths;
-    delete[] ctx->options.image_path;
     sass_free_context(ctx);
   }
 
   void free_file_context(sass_file_context* fctx) {
-    delete[] fctx->input_path;
-    delete[] fctx->options.include_paths;
-    delete[] fctx->options.image_path;
     sass_free_file_context(fctx);
   }
 
+  // room for `length` bytes and a terminating NUL
+  char* sass_arena_alloc(sass_arena* arena, size_t length) {
+    sass_arena_chunk* chunk = arena->head;
+
+    if (!chunk || chunk->size - chunk->used < length + 1) {
+      size_t size = chunk ? chunk->size * 2 : SASS_ARENA_CHUNK_SIZE;
+
+      while (size < length + 1) {
+        size *= 2;
+      }
+
+      chunk = (sass_arena_chunk*) malloc(sizeof(sass_arena_chunk) + size);
+      chunk->next = arena->head;
+      chunk->size = size;
+      chunk->used = 0;
+      arena->head = chunk;
+    }
+
+    char* data = (char*) (chunk + 1) + chunk->used;
+    data[length] = '\0';
+    chunk->used += length + 1;
+
+    return data;
+  }
+
+  char* sass_arena_copy(sass_arena* arena, const char* str, size_t length) {
+    char* copy = sass_arena_alloc(arena, length);
+    memcpy(copy, str, length);
+    return copy;
+  }
+
+  void sass_arena_reset(sass_arena* arena) {
+    if (!arena->head) {
+      return;
+    }
+
+    // the newest chunk is the largest, keep only that one
+    sass_arena_chunk* chunk = arena->head->next;
+    while (chunk) {
+      sass_arena_chunk* next = chunk->next;
+      free(chunk);
+      chunk = next;
+    }
+
+    arena->head->next = NULL;
+    arena->head->used = 0;
+
+    if (arena->head->size > SASS_ARENA_KEEP_SIZE) {
+      free(arena->head);
+      arena->head = NULL;
+    }
+  }
+
+  void sass_arena_free(sass_arena* arena) {
+    sass_arena_reset(arena);
+    free(arena->head);
+    arena->head = NULL;
+  }
+
   sass_context_wrapper* sass_new_context_wrapper() {
+    if (pooled > 0) {
+      return pool[--pooled];
+    }
+
     return (sass_context_wrapper*) calloc(1, sizeof(sass_context_wrapper));
   }
 
@@ -30,10 +103,30 @@ extern "C" {
       free_file_context(ctx_w->fctx);
     }
 
+    for (int i = 1; i < ctx_w->num_styles; i++) {
+      free(ctx_w->outputs[i]);
+      free(ctx_w->source_maps[i]);
+    }
+
+    free(ctx_w->source);
+    free(ctx_w->write_error);
+
     NanDisposePersistent(ctx_w->stats);
+    NanDisposePersistent(ctx_w->compiled);
     delete ctx_w->callback;
     delete ctx_w->errorCallback;
 
-    free(ctx_w);
+    if (pooled == SASS_WRAPPER_POOL_SIZE) {
+      sass_arena_free(&ctx_w->arena);
+      free(ctx_w);
+      return;
+    }
+
+    sass_arena arena = ctx_w->arena;
+    sass_arena_reset(&arena);
+
+    memset(ctx_w, 0, sizeof(sass_context_wrapper));
+    ctx_w->arena = arena;
+    pool[pooled++] = ctx_w;
   }
 }
@@ -1,5 +1,6 @@
 #include "libsass/sass_interface.h"
 #include <nan.h>
+#include "memory_budget.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -10,15 +11,64 @@ using namespace v8;
 void free_context(sass_context* ctx);
 void free_file_context(sass_file_context* fctx);
 
+// Bump allocator for the option strings of one compile. Everything in it is
+// released at once with the context, and its largest chunk, unless it is
+// very large, is kept for the next compile that reuses the same wrapper.
+struct sass_arena_chunk {
+  struct sass_arena_chunk* next;
+  size_t size;
+  size_t used;
+};
+
+struct sass_arena {
+  struct sass_arena_chunk* head;
+};
+
+char* sass_arena_alloc(struct sass_arena* arena, size_t length);
+char* sass_arena_copy(struct sass_arena* arena, const char* str, size_t length);
+void sass_arena_reset(struct sass_arena* arena);
+void sass_arena_free(struct sass_arena* arena);
+
+// nested, expanded, compact and compressed
+#define SASS_STYLE_COUNT 4
+
 struct sass_context_wrapper {
   sass_context* ctx;
   sass_file_context* fctx;
   Persistent<Object> stats;
+  Persistent<Object> compiled;
   uv_work_t request;
+  uint32_t id;
   NanCallback* callback;
   NanCallback* errorCallback;
+  bool output_buffer;
+  bool collect_stats;
+  bool trace;
+  int thread;
+  char* source;
+  char* css_path;
+  char* source_map_path;
+  char* write_error;
+  // set by `cancel()` once the compile is running, so its output is not
+  // written; guarded by the binding's `cancel_mutex`
+  bool cancelled;
+  uint64_t marshal_start;
+  uint64_t queue_start;
+  uint64_t compile_start;
+  uint64_t compile_end;
+  uint64_t write_end;
+  struct sass_arena arena;
+  // further output styles compiled in the same job; the context's own
+  // output is the first of them
+  int styles[SASS_STYLE_COUNT];
+  int num_styles;
+  char* outputs[SASS_STYLE_COUNT];
+  char* source_maps[SASS_STYLE_COUNT];
+  struct sass_memory_budget memory;
 };
 
+// Wrappers are recycled through a small free list, so they must only be
+// created and freed on the loop thread.
 struct sass_context_wrapper*      sass_new_context_wrapper(void);
 void sass_free_context_wrapper(struct sass_context_wrapper* ctx);
 
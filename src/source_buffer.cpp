@@ -0,0 +1,81 @@
+#include "source_buffer.h"
+#include <node_buffer.h>
+#include <cstdlib>
+#include <cstring>
+
+using namespace v8;
+
+Persistent<FunctionTemplate> SourceBuffer::constructor;
+
+SourceBuffer::SourceBuffer() : data(NULL), length(0), capacity(0) {}
+
+SourceBuffer::~SourceBuffer() {
+  free(data);
+}
+
+void SourceBuffer::Init(Handle<Object> target) {
+  Local<FunctionTemplate> tpl = NanNew<FunctionTemplate>(New);
+  tpl->SetClassName(NanNew("SourceBuffer"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "write", Write);
+
+  NanAssignPersistent(constructor, tpl);
+  target->Set(NanNew("SourceBuffer"), tpl->GetFunction());
+}
+
+bool SourceBuffer::HasInstance(Handle<Value> value) {
+  return value->IsObject() && NanNew(constructor)->HasInstance(value);
+}
+
+void SourceBuffer::Append(const char* chunk, size_t size) {
+  // one spare byte for the terminating NUL
+  if (length + size + 1 > capacity) {
+    size_t grown = capacity ? capacity : 4096;
+
+    while (grown < length + size + 1) {
+      grown *= 2;
+    }
+
+    data = (char*) realloc(data, grown);
+    capacity = grown;
+  }
+
+  memcpy(data + length, chunk, size);
+  length += size;
+}
+
+char* SourceBuffer::Take() {
+  char* source = data ? data : (char*) malloc(1);
+  source[length] = '\0';
+
+  data = NULL;
+  length = capacity = 0;
+  return source;
+}
+
+NAN_METHOD(SourceBuffer::New) {
+  NanScope();
+
+  SourceBuffer* buffer = new SourceBuffer();
+  buffer->Wrap(args.This());
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(SourceBuffer::Write) {
+  NanScope();
+
+  SourceBuffer* buffer = node::ObjectWrap::Unwrap<SourceBuffer>(args.This());
+
+  if (node::Buffer::HasInstance(args[0])) {
+    Local<Object> chunk = args[0]->ToObject();
+    buffer->Append(node::Buffer::Data(chunk), node::Buffer::Length(chunk));
+  } else if (args[0]->IsString()) {
+    String::Utf8Value chunk(args[0]);
+    buffer->Append(*chunk, chunk.length());
+  } else {
+    return NanThrowTypeError("chunk must be a Buffer or a string");
+  }
+
+  NanReturnValue(NanNew<Number>((double) buffer->length));
+}
@@ -0,0 +1,34 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <nan.h>
+#include <node_object_wrap.h>
+
+// Native buffer the source of a `data` compile is streamed into chunk by
+// chunk, so the whole stylesheet never has to exist as a JS string. Its
+// contents are handed to the context with `Take` when the compile starts.
+class SourceBuffer : public node::ObjectWrap {
+  public:
+    static void Init(v8::Handle<v8::Object> target);
+    static bool HasInstance(v8::Handle<v8::Value> value);
+
+    // Returns the NUL-terminated contents, allocated with malloc, and
+    // leaves the buffer empty.
+    char* Take();
+
+  private:
+    SourceBuffer();
+    ~SourceBuffer();
+
+    void Append(const char* chunk, size_t length);
+
+    static NAN_METHOD(New);
+    static NAN_METHOD(Write);
+    static v8::Persistent<v8::FunctionTemplate> constructor;
+
+    char* data;
+    size_t length;
+    size_t capacity;
+};
+
+#endif
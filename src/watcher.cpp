@@ -0,0 +1,146 @@
+#include "watcher.h"
+
+using namespace v8;
+using namespace std;
+
+Persistent<FunctionTemplate> Watcher::constructor;
+
+Watcher::Watcher(Handle<Function> callback) : callback(new NanCallback(callback)) {}
+
+Watcher::~Watcher() {
+  delete callback;
+}
+
+void Watcher::Init(Handle<Object> target) {
+  Local<FunctionTemplate> tpl = NanNew<FunctionTemplate>(New);
+  tpl->SetClassName(NanNew("Watcher"));
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "watch", Watch);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "unwatch", Unwatch);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "close", Close);
+
+  NanAssignPersistent(constructor, tpl);
+  target->Set(NanNew("Watcher"), tpl->GetFunction());
+}
+
+int Watcher::Add(const string& dir) {
+  if (entries.count(dir)) {
+    return 0;
+  }
+
+  Entry* entry = new Entry();
+  entry->watcher = this;
+  entry->dir = dir;
+  entry->handle.data = entry;
+
+#if UV_VERSION_MAJOR == 0 && UV_VERSION_MINOR < 11
+  int status = uv_fs_event_init(uv_default_loop(), &entry->handle, dir.c_str(), OnEvent, 0);
+
+  if (status != 0) {
+    // the handle is only registered with the loop once watching succeeded
+    delete entry;
+    return status;
+  }
+#else
+  uv_fs_event_init(uv_default_loop(), &entry->handle);
+  int status = uv_fs_event_start(&entry->handle, OnEvent, dir.c_str(), 0);
+
+  if (status != 0) {
+    entry->watcher = NULL;
+    uv_close((uv_handle_t*) &entry->handle, OnClose);
+    return status;
+  }
+#endif
+
+  // a watcher with open handles must outlive its JS object
+  if (entries.empty()) {
+    Ref();
+  }
+
+  entries[dir] = entry;
+  return 0;
+}
+
+void Watcher::Remove(const string& dir) {
+  map<string, Entry*>::iterator it = entries.find(dir);
+
+  if (it == entries.end()) {
+    return;
+  }
+
+  it->second->watcher = NULL;
+  uv_close((uv_handle_t*) &it->second->handle, OnClose);
+  entries.erase(it);
+
+  if (entries.empty()) {
+    Unref();
+  }
+}
+
+void Watcher::OnEvent(uv_fs_event_t* handle, const char* filename, int events, int status) {
+  NanScope();
+
+  Entry* entry = static_cast<Entry*>(handle->data);
+
+  // events still queued for a directory that has just been unwatched
+  if (!entry->watcher) {
+    return;
+  }
+
+  Local<Value> argv[] = {
+    NanNew<String>(entry->dir.c_str()),
+    filename ? (Local<Value>) NanNew<String>(filename) : (Local<Value>) NanNull(),
+    NanNew<Integer>(status)
+  };
+
+  entry->watcher->callback->Call(3, argv);
+}
+
+void Watcher::OnClose(uv_handle_t* handle) {
+  delete static_cast<Entry*>(handle->data);
+}
+
+NAN_METHOD(Watcher::New) {
+  NanScope();
+
+  if (!args[0]->IsFunction()) {
+    return NanThrowTypeError("callback must be a function");
+  }
+
+  Watcher* watcher = new Watcher(Local<Function>::Cast(args[0]));
+  watcher->Wrap(args.This());
+
+  NanReturnValue(args.This());
+}
+
+NAN_METHOD(Watcher::Watch) {
+  NanScope();
+
+  Watcher* watcher = node::ObjectWrap::Unwrap<Watcher>(args.This());
+  String::Utf8Value dir(args[0]);
+
+  NanReturnValue(NanNew<Integer>(watcher->Add(string(*dir, dir.length()))));
+}
+
+NAN_METHOD(Watcher::Unwatch) {
+  NanScope();
+
+  Watcher* watcher = node::ObjectWrap::Unwrap<Watcher>(args.This());
+  String::Utf8Value dir(args[0]);
+
+  watcher->Remove(string(*dir, dir.length()));
+  NanReturnUndefined();
+}
+
+NAN_METHOD(Watcher::Close) {
+  NanScope();
+
+  Watcher* watcher = node::ObjectWrap::Unwrap<Watcher>(args.This());
+
+  while (!watcher->entries.empty()) {
+    string dir = watcher->entries.begin()->first;
+    watcher->Remove(dir);
+  }
+
+  NanReturnUndefined();
+}
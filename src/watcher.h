@@ -0,0 +1,43 @@
+#ifndef WATCHER_H
+#define WATCHER_H
+
+#include <nan.h>
+#include <node_object_wrap.h>
+#include <map>
+#include <string>
+
+// Watches a set of directories with `uv_fs_event`, so changes are reported
+// by inotify, FSEvents or ReadDirectoryChangesW instead of being found by
+// polling. The callback is called on the loop thread with the directory,
+// the name of the entry that changed in it, if known, and the status.
+class Watcher : public node::ObjectWrap {
+  public:
+    static void Init(v8::Handle<v8::Object> target);
+
+  private:
+    struct Entry {
+      uv_fs_event_t handle;
+      Watcher* watcher;
+      std::string dir;
+    };
+
+    explicit Watcher(v8::Handle<v8::Function> callback);
+    ~Watcher();
+
+    int Add(const std::string& dir);
+    void Remove(const std::string& dir);
+
+    static void OnEvent(uv_fs_event_t* handle, const char* filename, int events, int status);
+    static void OnClose(uv_handle_t* handle);
+
+    static NAN_METHOD(New);
+    static NAN_METHOD(Watch);
+    static NAN_METHOD(Unwatch);
+    static NAN_METHOD(Close);
+    static v8::Persistent<v8::FunctionTemplate> constructor;
+
+    std::map<std::string, Entry*> entries;
+    NanCallback* callback;
+};
+
+#endif
@@ -1,5 +1,6 @@
 var assert = require('assert'),
     fs = require('fs'),
+    os = require('os'),
     path = require('path'),
     read = fs.readFileSync,
     sass = process.env.NODESASS_COV ? require('../lib-cov') : require('../lib'),
@@ -109,6 +110,21 @@ describe('api', function() {
       });
     });
 
+    it('should pass the error location to the error callback', function(done) {
+      sass.render({
+        data: 'a {\n  b: $undefined;\n}',
+        error: function(err, status, details) {
+          assert.equal(details.status, status);
+          assert.equal(details.line, 2);
+          assert.equal(details.column, null);
+          assert(details.message);
+          assert(err.indexOf(details.message) !== -1);
+          assert(Array.isArray(details.backtrace));
+          done();
+        }
+      });
+    });
+
     it('should compile with include paths', function(done) {
       var src = read(fixture('include-path/index.scss'), 'utf8');
       var expected = read(fixture('include-path/expected.css'), 'utf8').trim();
@@ -126,6 +142,43 @@ describe('api', function() {
       });
     });
 
+    it('should skip include paths that do not exist', function(done) {
+      var src = read(fixture('include-path/index.scss'), 'utf8');
+      var expected = read(fixture('include-path/expected.css'), 'utf8').trim();
+
+      sass.render({
+        data: src,
+        includePaths: [
+          fixture('include-path/missing'),
+          fixture('include-path/functions'),
+          fixture('include-path/functions'),
+          fixture('include-path/lib')
+        ],
+        success: function(css) {
+          assert.equal(css.trim(), expected.replace(/\r\n/g, '\n'));
+          done();
+        }
+      });
+    });
+
+    it('should pick up include paths created later', function(done) {
+      var dir = fixture('include-path/tmp');
+
+      assert.throws(function() {
+        sass.renderSync({data: '@import "tmp-lib";', includePaths: [dir]});
+      });
+
+      fs.mkdirSync(dir);
+      fs.writeFileSync(path.join(dir, '_tmp-lib.scss'), 'a{color:red}');
+
+      var css = sass.renderSync({data: '@import "tmp-lib";', includePaths: [dir], outputStyle: 'compressed'});
+
+      fs.unlinkSync(path.join(dir, '_tmp-lib.scss'));
+      fs.rmdirSync(dir);
+      assert.equal(css.trim(), 'a{color:red}');
+      done();
+    });
+
     it('should compile with image path', function(done) {
       var src = read(fixture('image-path/index.scss'), 'utf8');
       var expected = read(fixture('image-path/expected.css'), 'utf8').trim();
@@ -182,6 +235,86 @@ describe('api', function() {
       });
     });
 
+    it('should pass the source map to a callback that reads its arguments', function(done) {
+      sass.render({
+        file: fixture('simple/index.scss'),
+        outFile: fixture('simple/build.css'),
+        sourceMap: true,
+        success: function() {
+          assert.equal(JSON.parse(arguments[1]).version, 3);
+          done();
+        }
+      });
+    });
+
+    it('should return a Buffer with outputBuffer', function(done) {
+      var expected = read(fixture('simple/expected.css'), 'utf8').trim();
+
+      sass.render({
+        file: fixture('simple/index.scss'),
+        outputBuffer: true,
+        success: function(css) {
+          assert(Buffer.isBuffer(css));
+          assert.equal(css.toString().trim(), expected.replace(/\r\n/g, '\n'));
+          done();
+        }
+      });
+    });
+
+    it('should hand the source map over as a Buffer with outputBuffer', function(done) {
+      var stats = {};
+
+      sass.render({
+        file: fixture('simple/index.scss'),
+        outputBuffer: true,
+        sourceMap: true,
+        stats: stats,
+        success: function(css, sourceMap) {
+          assert(Buffer.isBuffer(sourceMap));
+          assert.equal(typeof stats.sourceMap, 'string');
+          assert.equal(stats.sourceMap, sourceMap.toString());
+          assert.equal(JSON.parse(stats.sourceMap).version, 3);
+          done();
+        }
+      });
+    });
+
+    it('should compile several output styles in one job', function(done) {
+      var src = fixture('compressed/index.scss');
+      var expected = read(fixture('compressed/expected.css'), 'utf8').trim();
+      var stats = {};
+
+      sass.render({
+        file: src,
+        outputStyle: ['nested', 'compressed'],
+        sourceMap: true,
+        outFile: fixture('compressed/index.css'),
+        stats: stats,
+        success: function(css, sourceMap) {
+          assert.equal(css.nested, sass.renderSync({file: src}));
+          assert.equal(css.compressed.trim(), expected.replace(/\r\n/g, '\n'));
+          assert.equal(JSON.parse(sourceMap.nested).version, 3);
+          assert.equal(JSON.parse(sourceMap.compressed).version, 3);
+          assert.deepEqual(stats.sourceMap, sourceMap);
+          done();
+        }
+      });
+    });
+
+    it('should fail a compile that exceeds maxMemory', function(done) {
+      sass.render({
+        file: fixture('include-files/index.scss'),
+        maxMemory: 1024,
+        error: function(err, status, details) {
+          assert(/maxMemory/.test(err));
+          assert.equal(status, 'ENOMEM');
+          assert.equal(details.status, 'ENOMEM');
+          assert.equal(details.line, null);
+          done();
+        }
+      });
+    });
+
     it('should contain an array of all included files in stats when data is passed', function(done) {
       var stats = {};
       sass.render({
@@ -228,6 +361,26 @@ describe('api', function() {
       done();
     });
 
+    it('should return a Buffer with outputBuffer', function(done) {
+      var src = read(fixture('simple/index.scss'), 'utf8');
+      var expected = read(fixture('simple/expected.css'), 'utf8').trim();
+      var css = sass.renderSync({data: src, outputBuffer: true});
+
+      assert(Buffer.isBuffer(css));
+      assert.equal(css.toString().trim(), expected.replace(/\r\n/g, '\n'));
+      done();
+    });
+
+    it('should compile several output styles', function(done) {
+      var src = read(fixture('compressed/index.scss'), 'utf8');
+      var css = sass.renderSync({data: src, outputStyle: ['compressed', 'nested', 'compressed']});
+
+      assert.deepEqual(Object.keys(css), ['compressed', 'nested']);
+      assert.equal(css.compressed, sass.renderSync({data: src, outputStyle: 'compressed'}));
+      assert.equal(css.nested, sass.renderSync({data: src}));
+      done();
+    });
+
     it('should throw error for bad input', function(done) {
       assert.throws(function() {
         sass.renderSync({data: '#navbar width 80%;'});
@@ -235,6 +388,660 @@ describe('api', function() {
 
       done();
     });
+
+    it('should throw an error carrying the error location', function(done) {
+      assert.throws(function() {
+        sass.renderSync({data: 'a {\n  b: $undefined;\n}'});
+      }, function(err) {
+        return err instanceof Error && err.line === 2 && err.status === 1;
+      });
+
+      done();
+    });
+
+    it('should throw an error for a compile that exceeds maxMemory', function(done) {
+      var src = fixture('include-files/index.scss');
+
+      assert.throws(function() {
+        sass.renderSync({file: src, maxMemory: 1024});
+      }, function(err) {
+        return err instanceof Error && /maxMemory/.test(err.message) && err.status === 'ENOMEM';
+      });
+
+      assert(sass.renderSync({file: src}));
+      done();
+    });
+  });
+
+  describe('.renderStream(options)', function() {
+    it('should compile a piped stream to css', function(done) {
+      var expected = read(fixture('simple/expected.css'), 'utf8').trim();
+      var chunks = [];
+      var stream = sass.renderStream();
+
+      stream.on('data', function(chunk) {
+        chunks.push(chunk);
+      });
+
+      stream.on('end', function() {
+        assert.equal(Buffer.concat(chunks).toString().trim(), expected.replace(/\r\n/g, '\n'));
+        assert.equal(stream.stats.entry, 'data');
+        done();
+      });
+
+      fs.createReadStream(fixture('simple/index.scss'), { highWaterMark: 16 }).pipe(stream);
+    });
+
+    it('should emit an error for invalid input', function(done) {
+      var stream = sass.renderStream();
+
+      stream.on('error', function(err) {
+        assert(err instanceof Error);
+        done();
+      });
+
+      stream.end('#navbar width 80%;');
+    });
+  });
+
+  describe('.renderBatch(batch, cb)', function() {
+    it('should compile every entry in order', function(done) {
+      var expected = [
+        read(fixture('simple/expected.css'), 'utf8').trim(),
+        read(fixture('compressed/expected.css'), 'utf8').trim()
+      ];
+
+      sass.renderBatch([
+        { file: fixture('simple/index.scss') },
+        { file: fixture('compressed/index.scss'), outputStyle: 'compressed' }
+      ], function(err, results) {
+        assert(!err);
+        assert.equal(results.length, 2);
+        assert.equal(results[0].css.trim(), expected[0].replace(/\r\n/g, '\n'));
+        assert.equal(results[1].css.trim(), expected[1].replace(/\r\n/g, '\n'));
+        done();
+      });
+    });
+
+    it('should call per-item callbacks', function(done) {
+      var called = [];
+
+      sass.renderBatch([
+        {
+          data: read(fixture('simple/index.scss'), 'utf8'),
+          success: function() {
+            called.push('success');
+          }
+        },
+        {
+          data: '#navbar width 80%;',
+          error: function(err, status) {
+            assert.equal(status, 1);
+            called.push('error');
+          }
+        }
+      ], function(err, results) {
+        assert(err);
+        assert(results[0].css);
+        assert.equal(results[1].status, 1);
+        assert.deepEqual(called.sort(), ['error', 'success']);
+        done();
+      });
+    });
+
+    it('should call back even if a per-item callback throws', function(done) {
+      var listeners = process.listeners('uncaughtException');
+      var called = false;
+
+      process.removeAllListeners('uncaughtException');
+      process.once('uncaughtException', function(err) {
+        listeners.forEach(function(listener) {
+          process.on('uncaughtException', listener);
+        });
+
+        assert.equal(err.message, 'entry');
+        assert(called);
+        done();
+      });
+
+      sass.renderBatch([
+        {
+          data: read(fixture('simple/index.scss'), 'utf8'),
+          success: function() {
+            throw new Error('entry');
+          }
+        }
+      ], function(err, results) {
+        assert(results[0].css);
+        called = true;
+      });
+    });
+
+    it('should call back with an empty array for an empty batch', function(done) {
+      sass.renderBatch([], function(err, results) {
+        assert(!err);
+        assert.deepEqual(results, []);
+        done();
+      });
+    });
+  });
+
+  describe('.render({parallelImports: true})', function() {
+    var dir = path.join(os.tmpdir(), 'node-sass-test-parallel-' + process.pid);
+
+    before(function() {
+      fs.mkdirSync(dir);
+      fs.writeFileSync(path.join(dir, '_settings.scss'), '$color: red;');
+      fs.writeFileSync(path.join(dir, '_a.scss'), 'a{color:$color}');
+      fs.writeFileSync(path.join(dir, '_b.scss'), 'b{color:$color}');
+      fs.writeFileSync(path.join(dir, 'index.scss'), '@import "settings";\n@import "a", "b";');
+      fs.writeFileSync(path.join(dir, '_mixins.scss'), '@mixin c{color:$color}');
+      fs.writeFileSync(path.join(dir, '_functions.scss'), '@function twice($n){@return $n * 2}');
+      fs.writeFileSync(path.join(dir, '_c.scss'), 'c{@include c;width:twice(1px)}');
+      fs.writeFileSync(path.join(dir, 'long.scss'), '@import "settings", "mixins", "functions", "c", "a", "b";');
+    });
+
+    after(function() {
+      fs.readdirSync(dir).forEach(function(name) {
+        fs.unlinkSync(path.join(dir, name));
+      });
+      fs.rmdirSync(dir);
+    });
+
+    it('should join the output of each import in order', function(done) {
+      var stats = {};
+
+      sass.render({
+        file: path.join(dir, 'index.scss'),
+        outputStyle: 'compressed',
+        parallelImports: true,
+        stats: stats,
+        success: function(css) {
+          assert.equal(css.trim(), 'a{color:red}b{color:red}');
+          assert.equal(stats.includedFiles.length, 4);
+          done();
+        }
+      });
+    });
+
+    it('should find a prelude of several imports', function(done) {
+      sass.render({
+        file: path.join(dir, 'long.scss'),
+        outputStyle: 'compressed',
+        parallelImports: true,
+        success: function(css) {
+          assert.equal(css.trim(), 'c{color:red;width:2px}a{color:red}b{color:red}');
+          done();
+        }
+      });
+    });
+
+    it('should compile other entries as a whole', function(done) {
+      var expected = read(fixture('simple/expected.css'), 'utf8').trim();
+
+      sass.render({
+        file: fixture('simple/index.scss'),
+        parallelImports: true,
+        success: function(css) {
+          assert.equal(css.trim(), expected.replace(/\r\n/g, '\n'));
+          done();
+        }
+      });
+    });
+  });
+
+  describe('.render(options).cancel()', function() {
+    it('should report a cancelled compile as an error', function(done) {
+      var handle = sass.render({
+        file: fixture('simple/index.scss'),
+        success: function() {
+          assert(false, 'success should not be called');
+        },
+        error: function(err, status) {
+          assert.equal(status, 'ECANCELED');
+          setTimeout(done, 100);
+        }
+      });
+
+      assert(handle.cancel());
+    });
+
+    it('should not cancel a finished compile', function(done) {
+      var handle = sass.render({
+        file: fixture('simple/index.scss'),
+        success: function() {
+          process.nextTick(function() {
+            assert(!handle.cancel());
+            done();
+          });
+        }
+      });
+    });
+
+    it('should time out with the timeout option', function(done) {
+      var until = Date.now() + 50;
+
+      sass.render({
+        data: '@for $i from 1 through 20000 { .a#{$i} { b: $i; } }',
+        timeout: 1,
+        success: function() {
+          done(new Error('success should not be called'));
+        },
+        error: function(err, status) {
+          assert(/timed out/.test(err));
+          assert.equal(status, 'ETIMEDOUT');
+          done();
+        }
+      });
+
+      // timers run before the loop polls for finished compiles, so the
+      // timeout fires first once the loop is held past it
+      while (Date.now() < until) {}
+    });
+  });
+
+  (global.Promise ? describe : describe.skip)('.renderAsync(options)', function() {
+    afterEach(function() {
+      sass.setQueueLimit(256, 'wait');
+    });
+
+    it('should resolve with the css and stats', function(done) {
+      var expected = read(fixture('simple/expected.css'), 'utf8').trim();
+
+      sass.renderAsync({file: fixture('simple/index.scss')}).then(function(result) {
+        assert.equal(result.css.trim(), expected.replace(/\r\n/g, '\n'));
+        assert.equal(result.stats.includedFiles.length, 1);
+        done();
+      }).catch(done);
+    });
+
+    it('should reject with the libsass status', function(done) {
+      sass.renderAsync({data: '#navbar width 80%;'}).then(function() {
+        done(new Error('should not resolve'));
+      }, function(err) {
+        assert(err instanceof Error);
+        assert.equal(err.status, 1);
+        done();
+      });
+    });
+
+    it('should resolve a deferred source map', function(done) {
+      sass.renderAsync({
+        file: fixture('simple/index.scss'),
+        outFile: fixture('simple/build.css'),
+        sourceMap: true,
+        deferSourceMap: true
+      }).then(function(result) {
+        return result.sourceMap;
+      }).then(function(sourceMap) {
+        assert.equal(JSON.parse(sourceMap).version, 3);
+        done();
+      }).catch(done);
+    });
+
+    it('should resolve a deferred source map with null without a map', function(done) {
+      Promise.all([
+        {data: 'a{color:red}', sourceMap: true, deferSourceMap: true},
+        {file: fixture('simple/index.scss'), deferSourceMap: true}
+      ].map(function(options) {
+        return sass.renderAsync(options).then(function(result) {
+          return result.sourceMap;
+        });
+      })).then(function(sourceMaps) {
+        assert.deepEqual(sourceMaps, [null, null]);
+        done();
+      }).catch(done);
+    });
+
+    it('should hold submissions beyond the limit until a compile finishes', function(done) {
+      sass.setQueueLimit(1, 'wait');
+
+      Promise.all([1, 2, 3].map(function() {
+        return sass.renderAsync({file: fixture('simple/index.scss')});
+      })).then(function(results) {
+        assert.equal(results.length, 3);
+        done();
+      }).catch(done);
+    });
+
+    it('should reject submissions beyond the limit', function(done) {
+      sass.setQueueLimit(1, 'reject');
+
+      var first = sass.renderAsync({file: fixture('simple/index.scss')});
+
+      sass.renderAsync({file: fixture('simple/index.scss')}).catch(function(err) {
+        assert.equal(err.status, 'EQUEUEFULL');
+        first.then(function() {
+          done();
+        });
+      });
+    });
+  });
+
+  describe('.setConcurrency(size)', function() {
+    var original;
+
+    before(function() {
+      original = sass.getConcurrency();
+    });
+
+    after(function() {
+      sass.setConcurrency(original);
+    });
+
+    it('should resize the compile pool', function(done) {
+      sass.setConcurrency(2);
+      assert.equal(sass.getConcurrency(), 2);
+      done();
+    });
+
+    it('should throw error for a non-positive size', function(done) {
+      assert.throws(function() {
+        sass.setConcurrency(0);
+      });
+
+      done();
+    });
+
+    it('should compile with a single thread', function(done) {
+      var expected = read(fixture('simple/expected.css'), 'utf8').trim();
+
+      sass.setConcurrency(1);
+      sass.render({
+        file: fixture('simple/index.scss'),
+        success: function(css) {
+          assert.equal(css.trim(), expected.replace(/\r\n/g, '\n'));
+          done();
+        }
+      });
+    });
+  });
+
+  describe('.render({cache: true})', function() {
+    var src = fixture('include-files/index.scss');
+
+    beforeEach(function() {
+      sass.cache.clear();
+    });
+
+    it('should reuse the output of an unchanged compile', function(done) {
+      var stats = {};
+
+      sass.render({
+        file: src,
+        cache: true,
+        success: function(first) {
+          sass.render({
+            file: src,
+            cache: true,
+            stats: stats,
+            success: function(second) {
+              assert(stats.cached);
+              assert.equal(second, first);
+              assert.equal(stats.includedFiles.length, 3);
+              done();
+            }
+          });
+        }
+      });
+    });
+
+    it('should not reuse output when options differ', function(done) {
+      var stats = {};
+
+      sass.renderSync({file: src, cache: true});
+      sass.renderSync({file: src, cache: true, outputStyle: 'compressed', stats: stats});
+
+      assert(!stats.cached);
+      done();
+    });
+
+    it('should recompile when an included file changes', function(done) {
+      var tmp = fixture('simple/tmp.scss');
+      var stats = {};
+
+      fs.writeFileSync(tmp, 'a { color: red; }');
+      sass.renderSync({file: tmp, cache: true});
+      fs.writeFileSync(tmp, 'a { color: blue; }');
+
+      var css = sass.renderSync({file: tmp, cache: true, stats: stats});
+
+      assert(!stats.cached);
+      assert(css.indexOf('blue') !== -1);
+      fs.unlinkSync(tmp);
+      done();
+    });
+
+    it('should accept a private cache instance', function(done) {
+      var cache = new sass.Cache();
+      var stats = {};
+
+      sass.renderSync({file: src, cache: cache});
+      sass.renderSync({file: src, cache: true, stats: stats});
+      assert(!stats.cached);
+
+      sass.renderSync({file: src, cache: cache, stats: stats});
+      assert(stats.cached);
+      done();
+    });
+
+    it('should hand out cached output in the kind asked for', function(done) {
+      var cache = new sass.Cache();
+      var stats = {};
+      var buffer = sass.renderSync({file: src, cache: cache, outputBuffer: true});
+      var css = sass.renderSync({file: src, cache: cache, stats: stats});
+
+      assert(stats.cached);
+      assert(Buffer.isBuffer(buffer));
+      assert.equal(typeof css, 'string');
+      assert.equal(css, buffer.toString());
+      assert(Buffer.isBuffer(sass.renderSync({file: src, cache: cache, outputBuffer: true})));
+      done();
+    });
+
+    it('should drop the least recently used entry beyond max', function(done) {
+      var cache = new sass.Cache({max: 2});
+      var stats = {};
+
+      sass.renderSync({data: 'a { b: 1; }', cache: cache});
+      sass.renderSync({data: 'a { b: 2; }', cache: cache});
+      sass.renderSync({data: 'a { b: 1; }', cache: cache});
+      sass.renderSync({data: 'a { b: 3; }', cache: cache});
+      assert.equal(cache.size, 2);
+
+      sass.renderSync({data: 'a { b: 1; }', cache: cache, stats: stats});
+      assert(stats.cached);
+
+      sass.renderSync({data: 'a { b: 2; }', cache: cache, stats: stats});
+      assert(!stats.cached);
+      done();
+    });
+
+    it('should not reuse output of files modified after the compile started', function(done) {
+      var cache = new sass.Cache();
+
+      cache.set({file: src}, 'a{}', null, [src], 0);
+      cache.lookup({file: src}, function(stale) {
+        assert.equal(stale, null);
+
+        cache.set({file: src}, 'a{}', null, [src], Date.now() + 1000);
+        cache.lookup({file: src}, function(entry) {
+          assert.equal(entry.css, 'a{}');
+          done();
+        });
+      });
+    });
+  });
+
+  describe('.render({cacheDir: dir})', function() {
+    var src = fixture('include-files/index.scss');
+    var dir = path.join(os.tmpdir(), 'node-sass-test-cache-' + process.pid);
+
+    after(function() {
+      fs.readdirSync(dir).forEach(function(file) {
+        fs.unlinkSync(path.join(dir, file));
+      });
+
+      fs.rmdirSync(dir);
+    });
+
+    it('should reuse output stored on disk', function(done) {
+      var stats = {};
+      var first = sass.renderSync({file: src, cacheDir: dir});
+
+      sass.render({
+        file: src,
+        cacheDir: dir,
+        stats: stats,
+        success: function(second) {
+          assert(stats.cached);
+          assert.equal(second, first);
+          assert.equal(stats.includedFiles.length, 3);
+          done();
+        }
+      });
+    });
+
+    it('should recompile when an included file changes', function(done) {
+      var tmp = fixture('simple/tmp.scss');
+      var stats = {};
+
+      fs.writeFileSync(tmp, 'a { color: red; }');
+      sass.renderSync({file: tmp, cacheDir: dir});
+      fs.writeFileSync(tmp, 'a { color: blue; }');
+
+      var css = sass.renderSync({file: tmp, cacheDir: dir, stats: stats});
+
+      assert(!stats.cached);
+      assert(css.indexOf('blue') !== -1);
+      fs.unlinkSync(tmp);
+      done();
+    });
+
+    it('should store output asynchronously', function(done) {
+      var cache = new sass.Cache.DiskCache(dir);
+      var options = {file: src, style: 1};
+
+      cache.store(options, 'a{}', null, [src], Date.now() + 1000, function(err) {
+        assert(!err);
+        cache.lookup(options, function(entry) {
+          assert.equal(entry.css, 'a{}');
+          done();
+        });
+      });
+    });
+
+    it('should treat a corrupt manifest as a miss', function(done) {
+      var cache = new sass.Cache.DiskCache(dir);
+      var options = {file: src, style: 2};
+
+      cache.store(options, 'a{}', null, [src], Date.now() + 1000, function() {
+        fs.readdirSync(dir).filter(function(file) {
+          return path.extname(file) === '.json';
+        }).forEach(function(file) {
+          fs.writeFileSync(path.join(dir, file), '{"includedFi');
+        });
+
+        assert.equal(cache.get(options), null);
+        cache.lookup(options, function(entry) {
+          assert.equal(entry, null);
+          done();
+        });
+      });
+    });
+  });
+
+  describe('.createPrelude(options)', function() {
+    it('should compile data after the prelude', function(done) {
+      var prelude = sass.createPrelude({data: '$color: red;'});
+      var css = sass.renderSync({prelude: prelude, data: 'a{color:$color}', outputStyle: 'compressed'});
+
+      assert.equal(css.trim(), 'a{color:red}');
+      done();
+    });
+
+    it('should resolve the imports of a file prelude next to it', function(done) {
+      var prelude = sass.createPrelude({file: fixture('include-files/index.scss')});
+      var stats = {};
+
+      sass.render({
+        prelude: prelude,
+        data: 'a{color:red}',
+        stats: stats,
+        success: function() {
+          assert(stats.includedFiles.indexOf(fixture('include-files/foo.scss').replace(/\\/g, '/')) !== -1);
+          done();
+        }
+      });
+    });
+
+    it('should throw error for a prelude with a file compile', function(done) {
+      assert.throws(function() {
+        sass.renderSync({prelude: sass.createPrelude({data: ''}), file: fixture('simple/index.scss')});
+      });
+      done();
+    });
+  });
+
+  describe('.createOptions(options)', function() {
+    var expected = read(fixture('include-path/expected.css'), 'utf8').trim().replace(/\r\n/g, '\n');
+    var compiled;
+
+    before(function() {
+      compiled = sass.createOptions({
+        data: read(fixture('include-path/index.scss'), 'utf8'),
+        includePaths: [
+          fixture('include-path/functions'),
+          fixture('include-path/lib')
+        ]
+      });
+    });
+
+    it('should return frozen options', function(done) {
+      assert(Object.isFrozen(compiled));
+      done();
+    });
+
+    it('should compile asynchronously more than once', function(done) {
+      sass.render({
+        compiled: compiled,
+        success: function(first) {
+          assert.equal(first.trim(), expected);
+
+          sass.render({
+            compiled: compiled,
+            success: function(second) {
+              assert.equal(second.trim(), expected);
+              done();
+            }
+          });
+        }
+      });
+    });
+
+    it('should compile synchronously with per-call stats', function(done) {
+      var stats = {};
+      var css = sass.renderSync({compiled: compiled, stats: stats});
+
+      assert.equal(css.trim(), expected);
+      assert.equal(stats.entry, 'data');
+      done();
+    });
+
+    it('should compile files', function(done) {
+      var file = sass.createOptions({
+        file: fixture('compressed/index.scss'),
+        outputStyle: 'compressed'
+      });
+
+      sass.render({
+        compiled: file,
+        success: function(css) {
+          assert.equal(css.trim(), read(fixture('compressed/expected.css'), 'utf8').trim());
+          done();
+        }
+      });
+    });
   });
 
   describe('.renderFile(options)', function() {
@@ -309,6 +1116,36 @@ describe('api', function() {
       });
     });
 
+    it('should not pass the CSS through the success callback', function(done) {
+      var dest = fixture('simple/build.css');
+      var stats = {};
+
+      sass.renderFile({
+        file: fixture('simple/index.scss'),
+        outFile: dest,
+        stats: stats,
+        success: function(file) {
+          assert.equal(file, dest);
+          assert(!stats.sourceMap);
+          assert(fs.existsSync(dest));
+          fs.unlinkSync(dest);
+          done();
+        }
+      });
+    });
+
+    it('should call error when the output cannot be written', function(done) {
+      sass.renderFile({
+        file: fixture('simple/index.scss'),
+        outFile: fixture('simple/missing/build.css'),
+        error: function(err) {
+          assert(err instanceof Error);
+          assert(err.message.indexOf('Could not write') !== -1);
+          done();
+        }
+      });
+    });
+
     it('should save source paths relative to the source map file', function(done) {
       var src = fixture('include-files/index.scss');
       var dest = fixture('include-files/build.css');
@@ -367,6 +1204,19 @@ describe('api', function() {
       done();
     });
 
+    it('should provide the peak memory of the compile', function(done) {
+      assert(stats.peakMemory > 0);
+      done();
+    });
+
+    it('should provide per-phase timings', function(done) {
+      ['marshalMs', 'queuedMs', 'compileMs', 'callbackMs'].forEach(function(name) {
+        assert(typeof stats[name] === 'number');
+        assert(stats[name] >= 0);
+      });
+      done();
+    });
+
     it('should contain the given entry file', function(done) {
       assert.equal(stats.entry, fixture('include-files/index.scss'));
       done();
@@ -385,6 +1235,36 @@ describe('api', function() {
       done();
     });
 
+    it('should only split includedFiles when it is read', function(done) {
+      var descriptor = Object.getOwnPropertyDescriptor(stats, 'includedFiles');
+
+      assert.equal(typeof descriptor.get, 'function');
+      assert(Array.isArray(stats.includedFiles));
+      done();
+    });
+
+    it('should compile without stats when stats is false', function(done) {
+      var fields = ['includedFiles', 'marshalMs', 'queuedMs', 'compileMs', 'callbackMs', 'peakMemory'];
+      var collected = {};
+      var options = {
+        file: fixture('include-files/index.scss'),
+        stats: false,
+        success: function(css) {
+          assert(css);
+
+          // the binding fills in the object the options were given
+          fields.forEach(function(field) {
+            assert(field in collected, field + ' is collected with stats');
+            assert(!(field in options.stats), field + ' is skipped without stats');
+          });
+          done();
+        }
+      };
+
+      sass.renderSync({file: options.file, stats: collected});
+      sass.render(options);
+    });
+
     it('should contain array with the entry if there are no import statements', function(done) {
       var expected = fixture('simple/index.scss').replace(/\\/g, '/');
 
@@ -468,6 +1348,15 @@ describe('api', function() {
       done();
     });
 
+    it('should provide per-phase timings', function(done) {
+      ['marshalMs', 'compileMs', 'callbackMs'].forEach(function(name) {
+        assert(typeof stats[name] === 'number');
+        assert(stats[name] >= 0);
+      });
+      assert.equal(stats.queuedMs, 0);
+      done();
+    });
+
     it('should contain the given entry file', function(done) {
       assert.equal(stats.entry, resolveFixture('include-files/index.scss'));
       done();
@@ -532,6 +1421,93 @@ describe('api', function() {
     });
   });
 
+  describe('.startTracing()', function() {
+    afterEach(function() {
+      sass.stopTracing();
+    });
+
+    it('should record trace events for each compile', function(done) {
+      var tracer = sass.startTracing();
+
+      sass.render({
+        file: fixture('simple/index.scss'),
+        success: function() {
+          var names = tracer.toJSON().traceEvents.filter(function(event) {
+            return event.ph === 'X';
+          }).map(function(event) {
+            assert.equal(event.args.entry, fixture('simple/index.scss'));
+            return event.name;
+          });
+
+          assert.deepEqual(names, ['marshal', 'compile', 'callback']);
+          done();
+        }
+      });
+    });
+
+    it('should emit trace events', function(done) {
+      var tracer = sass.startTracing();
+      var events = [];
+
+      tracer.on('event', function(event) {
+        events.push(event);
+      });
+
+      sass.renderSync({data: 'a{color:red}'});
+      assert(events.some(function(event) {
+        return event.name === 'compile' && event.tid === 0;
+      }));
+      done();
+    });
+
+    it('should trace compiles with compiled options', function(done) {
+      var compiled = sass.createOptions({data: 'a{color:red}'});
+      var tracer = sass.startTracing();
+
+      sass.renderSync({compiled: compiled});
+      sass.stopTracing();
+      assert(tracer.events.some(function(event) {
+        return event.name === 'compile';
+      }));
+
+      sass.renderSync({compiled: compiled});
+      assert.equal(tracer.events.filter(function(event) {
+        return event.name === 'compile';
+      }).length, 1);
+      done();
+    });
+
+    it('should not trace after stopTracing', function(done) {
+      var tracer = sass.startTracing();
+
+      assert.equal(sass.stopTracing(), tracer);
+      sass.renderSync({data: 'a{color:red}'});
+      assert.equal(tracer.events.length, 0);
+      done();
+    });
+
+    it('should include an async callback in its callback span', function(done) {
+      var tracer = sass.startTracing();
+
+      tracer.on('event', function(event) {
+        if (event.name === 'callback') {
+          sass.stopTracing();
+          assert(event.dur >= 20000);
+          done();
+        }
+      });
+
+      sass.render({
+        data: 'a{color:red}',
+        success: function() {
+          var until = Date.now() + 25;
+
+          while (Date.now() < until) {}
+        }
+      });
+    });
+  });
+
   describe('.middleware()', function() {
     it('should throw error on require', function(done) {
       assert.throws(sass.middleware());
@@ -190,6 +190,92 @@ describe('cli', function() {
     });
   });
 
+  describe('node-sass in.scss --watch partial.scss', function() {
+    it('should render the entries that import a changed partial', function(done) {
+      var src = fixture('simple/tmp-entry.scss');
+      var partial = fixture('simple/_tmp-partial.scss');
+
+      fs.writeFileSync(src, '@import "tmp-partial";\na{color:red}');
+      fs.writeFileSync(partial, '');
+
+      var bin = spawn(cli, [
+        src, '--stdout', '--watch', partial,
+        '--output-style', 'compressed'
+      ]);
+
+      bin.stdout.setEncoding('utf8');
+      bin.stdout.on('data', function(data) {
+        assert.equal(data.trim(), 'body{background:white}a{color:red}');
+        bin.kill();
+        fs.unlinkSync(src);
+        fs.unlinkSync(partial);
+        done();
+      });
+
+      setTimeout(function() {
+        fs.appendFileSync(partial, 'body{background:white}');
+      }, 500);
+    });
+
+    it('should render an entry when a partial it failed to import appears', function(done) {
+      var src = fixture('simple/tmp-missing.scss');
+      var partial = fixture('simple/_tmp-missing.scss');
+
+      fs.writeFileSync(src, '@import "tmp-missing";');
+
+      var bin = spawn(cli, [
+        src, '--stdout', '--watch',
+        '--output-style', 'compressed'
+      ]);
+
+      bin.stdout.setEncoding('utf8');
+      bin.stdout.on('data', function(data) {
+        assert.equal(data.trim(), 'a{color:red}');
+        bin.kill();
+        fs.unlinkSync(src);
+        fs.unlinkSync(partial);
+        done();
+      });
+
+      setTimeout(function() {
+        fs.writeFileSync(partial, 'a{color:red}');
+      }, 500);
+    });
+
+    it('should render an entry once for a burst of changes', function(done) {
+      var src = fixture('simple/tmp-burst.scss');
+      var partial = fixture('simple/_tmp-burst.scss');
+      var output = '';
+
+      fs.writeFileSync(src, '@import "tmp-burst";');
+      fs.writeFileSync(partial, '');
+
+      var bin = spawn(cli, [
+        src, '--stdout', '--watch', partial,
+        '--output-style', 'compressed'
+      ]);
+
+      bin.stdout.setEncoding('utf8');
+      bin.stdout.on('data', function(data) {
+        output += data;
+      });
+
+      setTimeout(function() {
+        fs.appendFileSync(partial, 'a{color:red}');
+        fs.appendFileSync(partial, 'b{color:red}');
+        fs.appendFileSync(partial, 'i{color:red}');
+      }, 500);
+
+      setTimeout(function() {
+        assert.equal(output.trim(), 'a{color:red}b{color:red}i{color:red}');
+        bin.kill();
+        fs.unlinkSync(src);
+        fs.unlinkSync(partial);
+        done();
+      }, 1500);
+    });
+  });
+
   describe('node-sass in.scss --output out.css', function() {
     it('should compile a scss file to build.css', function(done) {
       var src = fixture('simple/index.scss');
@@ -234,4 +320,138 @@ describe('cli', function() {
       });
     });
   });
+
+  describe('node-sass dir --output dir', function() {
+    it('should render every entry of a directory in parallel', function(done) {
+      var src = fixture('tmp-dir');
+      var dest = fixture('tmp-dir-build');
+
+      fs.mkdirSync(src);
+      fs.mkdirSync(path.join(src, 'nested'));
+      fs.writeFileSync(path.join(src, '_partial.scss'), 'a{color:red}');
+      fs.writeFileSync(path.join(src, 'one.scss'), '@import "partial";');
+      fs.writeFileSync(path.join(src, 'nested', 'two.scss'), 'b{color:blue}');
+
+      var bin = spawn(cli, [
+        src, '--output', dest, '--recursive', '--jobs', '2',
+        '--output-style', 'compressed'
+      ]);
+
+      bin.on('close', function() {
+        assert.equal(read(path.join(dest, 'one.css'), 'utf8').trim(), 'a{color:red}');
+        assert.equal(read(path.join(dest, 'nested', 'two.css'), 'utf8').trim(), 'b{color:blue}');
+        assert(!fs.existsSync(path.join(dest, '_partial.css')));
+
+        [
+          path.join(dest, 'nested', 'two.css'),
+          path.join(dest, 'one.css'),
+          path.join(src, 'nested', 'two.scss'),
+          path.join(src, 'one.scss'),
+          path.join(src, '_partial.scss')
+        ].forEach(fs.unlinkSync);
+        [
+          path.join(dest, 'nested'),
+          dest,
+          path.join(src, 'nested'),
+          src
+        ].forEach(fs.rmdirSync);
+        done();
+      });
+    });
+  });
+
+  describe('node-sass dir dir', function() {
+    it('should render into the positional output directory past failing entries', function(done) {
+      var src = fixture('tmp-dir-positional');
+      var dest = fixture('tmp-dir-positional-build');
+
+      fs.mkdirSync(src);
+      fs.writeFileSync(path.join(src, 'bad.scss'), 'a { color: $undefined; }');
+      fs.writeFileSync(path.join(src, 'good.scss'), 'b{color:blue}');
+
+      var bin = spawn(cli, [src, dest, '--output-style', 'compressed']);
+
+      bin.on('close', function(code) {
+        assert.equal(code, 1);
+        assert.equal(read(path.join(dest, 'good.css'), 'utf8').trim(), 'b{color:blue}');
+        assert(!fs.existsSync(path.join(dest, 'bad.css')));
+
+        [
+          path.join(dest, 'good.css'),
+          path.join(src, 'good.scss'),
+          path.join(src, 'bad.scss')
+        ].forEach(fs.unlinkSync);
+        [dest, src].forEach(fs.rmdirSync);
+        done();
+      });
+    });
+  });
+
+  describe('node-sass --server', function() {
+    it('should answer render requests on stdin', function(done) {
+      var src = fixture('simple/index.scss');
+      var expected = read(fixture('simple/expected.css'), 'utf8').trim();
+      var bin = spawn(cli, ['--server']);
+      var output = '';
+
+      bin.stdout.setEncoding('utf8');
+      bin.stdout.on('data', function(data) {
+        output += data;
+
+        if (output.indexOf('\n') === -1) {
+          return;
+        }
+
+        var response = JSON.parse(output);
+
+        assert.equal(response.id, 1);
+        assert.equal(response.result.css.trim(), expected.replace(/\r\n/g, '\n'));
+        assert.equal(response.result.stats.includedFiles.length, 1);
+        bin.kill();
+        done();
+      });
+
+      bin.stdin.write(JSON.stringify({
+        jsonrpc: '2.0',
+        id: 1,
+        method: 'render',
+        params: { file: src }
+      }) + '\n');
+    });
+
+    it('should answer compile errors with a JSON-RPC error and skip notifications', function(done) {
+      var bin = spawn(cli, ['--server']);
+      var output = '';
+
+      bin.stdout.setEncoding('utf8');
+      bin.stdout.on('data', function(data) {
+        output += data;
+
+        if (output.indexOf('\n') === -1) {
+          return;
+        }
+
+        var response = JSON.parse(output);
+
+        assert.equal(response.id, 2);
+        assert.equal(response.error.code, -32000);
+        assert.equal(response.error.data.status, 1);
+        assert.equal(typeof response.error.message, 'string');
+        bin.kill();
+        done();
+      });
+
+      bin.stdin.write(JSON.stringify({
+        jsonrpc: '2.0',
+        method: 'render',
+        params: { data: 'a{b:c}' }
+      }) + '\n');
+      bin.stdin.write(JSON.stringify({
+        jsonrpc: '2.0',
+        id: 2,
+        method: 'render',
+        params: { data: 'a { b: $undefined; }' }
+      }) + '\n');
+    });
+  });
 });